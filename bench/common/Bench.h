@@ -0,0 +1,99 @@
+#ifndef AFINA_BENCH_COMMON_BENCH_H
+#define AFINA_BENCH_COMMON_BENCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <afina/execute/HdrBuckets.h>
+
+namespace Afina {
+namespace Bench {
+
+/**
+ * # Latency histogram
+ * Same layout Execute::Latency uses, see Execute::HdrBuckets, only with finer buckets over the whole 64-bit
+ * range: any value is reported with error under 1 / SubBuckets while a few thousand counters are taken
+ */
+class Histogram {
+public:
+    typedef Execute::HdrBuckets<6> Layout;
+    static constexpr std::size_t SubBuckets = Layout::SubBuckets;
+    static constexpr std::size_t Buckets = Layout::Buckets;
+
+    Histogram() : _counts(Layout::Buckets, 0), _total(0), _max(0) {}
+
+    void Record(uint64_t value) {
+        _counts[Layout::Index(value)]++;
+        _total++;
+        _max = std::max(_max, value);
+    }
+
+    void Merge(const Histogram &other) {
+        for (std::size_t i = 0; i < _counts.size(); i++) {
+            _counts[i] += other._counts[i];
+        }
+        _total += other._total;
+        _max = std::max(_max, other._max);
+    }
+
+    inline uint64_t Total() const { return _total; }
+    inline uint64_t Max() const { return _max; }
+
+    /**
+     * Smallest value which isn't exceeded by the given share of the recorded ones, p is in [0, 1]
+     */
+    uint64_t Percentile(double p) const {
+        uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p * _total)));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < _counts.size(); i++) {
+            seen += _counts[i];
+            if (seen >= rank) {
+                return std::min(Layout::Highest(i), _max);
+            }
+        }
+        return _max;
+    }
+
+private:
+    std::vector<uint64_t> _counts;
+    uint64_t _total;
+    uint64_t _max;
+};
+
+/**
+ * # Key popularity
+ * Zipf distribution over n ranks which are scattered over the key space, so that hot keys aren't neighbours.
+ * Exponent close to 1 is the one real cache traffic usually has, 0 makes it uniform
+ */
+class Zipf {
+public:
+    Zipf(std::size_t n, double s = 0.99) : _cdf(n) {
+        double sum = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(double(i + 1), s);
+            _cdf[i] = sum;
+        }
+        for (auto &p : _cdf) {
+            p /= sum;
+        }
+    }
+
+    template <typename R> uint32_t operator()(R &rnd) const {
+        double p = std::uniform_real_distribution<double>(0, 1)(rnd);
+        std::size_t rank = std::lower_bound(_cdf.begin(), _cdf.end(), p) - _cdf.begin();
+        rank = std::min(rank, _cdf.size() - 1);
+        return uint32_t((rank * 2654435761u) % _cdf.size());
+    }
+
+private:
+    std::vector<double> _cdf;
+};
+
+} // namespace Bench
+} // namespace Afina
+
+#endif // AFINA_BENCH_COMMON_BENCH_H
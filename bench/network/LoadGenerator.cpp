@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <common/Bench.h>
+#include <cxxopts.hpp>
+
+namespace {
+
+using Afina::Bench::Histogram;
+using Afina::Bench::Zipf;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    std::string host;
+    uint16_t port;
+    unsigned connections;
+    unsigned threads;
+    unsigned pipeline;
+    double duration;
+    double get_ratio;
+    unsigned keys;
+    unsigned value_size;
+    double zipf;
+};
+
+// What a thread has seen during the run
+struct Report {
+    Histogram latency;
+    uint64_t gets = 0;
+    uint64_t hits = 0;
+    uint64_t sets = 0;
+    uint64_t errors = 0;
+};
+
+// Persistent connection with a window of pipelined requests
+struct Connection {
+    int socket;
+    std::string out;
+    std::size_t written = 0;
+    std::string in;
+
+    // Requests in flight: whether it is get and when it was sent
+    struct Sent {
+        bool get;
+        Clock::time_point at;
+    };
+    std::deque<Sent> sent;
+
+    // Whether the response being received already has a value
+    bool hit = false;
+};
+
+int connect_to(const Options &options) {
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        close(s);
+        throw std::runtime_error("Invalid address: " + options.host);
+    }
+    if (connect(s, (struct sockaddr *)&address, sizeof(address)) == -1) {
+        close(s);
+        throw std::runtime_error("Failed to connect: " + std::string(strerror(errno)));
+    }
+
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+    return s;
+}
+
+class Worker {
+public:
+    Worker(const Options &options, const Zipf &keys, unsigned connections, unsigned seed)
+        : _options(options), _keys(keys), _rnd(seed), _value(options.value_size, 'v') {
+        _epoll = epoll_create1(0);
+        if (_epoll == -1) {
+            throw std::runtime_error("Failed to create epoll: " + std::string(strerror(errno)));
+        }
+        for (unsigned i = 0; i < connections; i++) {
+            _connections.emplace_back(new Connection);
+            _connections.back()->socket = connect_to(options);
+        }
+    }
+
+    ~Worker() {
+        for (auto &conn : _connections) {
+            close(conn->socket);
+        }
+        close(_epoll);
+    }
+
+    void Run(Clock::time_point deadline) {
+        for (auto &conn : _connections) {
+            struct epoll_event event;
+            event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+            event.data.ptr = conn.get();
+            if (epoll_ctl(_epoll, EPOLL_CTL_ADD, conn->socket, &event) == -1) {
+                throw std::runtime_error("Failed to add socket to epoll: " + std::string(strerror(errno)));
+            }
+            _fill(*conn);
+        }
+
+        struct epoll_event events[64];
+        while (Clock::now() < deadline) {
+            int n = epoll_wait(_epoll, events, 64, 100);
+            if (n == -1 && errno != EINTR) {
+                throw std::runtime_error("Failed to wait for events: " + std::string(strerror(errno)));
+            }
+            for (int i = 0; i < n; i++) {
+                Connection &conn = *static_cast<Connection *>(events[i].data.ptr);
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    throw std::runtime_error("Connection closed by server");
+                }
+                if (events[i].events & EPOLLIN) {
+                    _receive(conn);
+                }
+                _fill(conn);
+            }
+        }
+    }
+
+    inline const Report &Result() const { return _report; }
+
+private:
+    // Tops the window of requests up and writes as much as socket takes
+    void _fill(Connection &conn) {
+        char key[32];
+        while (conn.sent.size() < _options.pipeline) {
+            int size = snprintf(key, sizeof(key), "key:%u", _keys(_rnd));
+            bool get = std::uniform_real_distribution<double>(0, 1)(_rnd) < _options.get_ratio;
+            if (get) {
+                conn.out.append("get ").append(key, size).append("\r\n");
+            } else {
+                conn.out.append("set ").append(key, size).append(" 0 0 ").append(std::to_string(_value.size()));
+                conn.out.append("\r\n").append(_value).append("\r\n");
+            }
+            conn.sent.push_back({get, Clock::now()});
+        }
+
+        while (conn.written < conn.out.size()) {
+            ssize_t n = write(conn.socket, conn.out.data() + conn.written, conn.out.size() - conn.written);
+            if (n > 0) {
+                conn.written += n;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            } else {
+                throw std::runtime_error("Failed to write: " + std::string(strerror(errno)));
+            }
+        }
+        conn.out.clear();
+        conn.written = 0;
+    }
+
+    void _receive(Connection &conn) {
+        char buffer[64 * 1024];
+        while (true) {
+            ssize_t n = read(conn.socket, buffer, sizeof(buffer));
+            if (n > 0) {
+                conn.in.append(buffer, n);
+            } else if (n == 0) {
+                throw std::runtime_error("Connection closed by server");
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else {
+                throw std::runtime_error("Failed to read: " + std::string(strerror(errno)));
+            }
+        }
+        _parse(conn);
+    }
+
+    // Cuts complete responses out of the input and accounts them
+    void _parse(Connection &conn) {
+        std::size_t pos = 0;
+        while (!conn.sent.empty()) {
+            std::size_t eol = conn.in.find("\r\n", pos);
+            if (eol == std::string::npos) {
+                break;
+            }
+
+            if (conn.in.compare(pos, 6, "VALUE ") == 0) {
+                // Value line tells size of the data block which follows it
+                std::size_t space = conn.in.rfind(' ', eol);
+                std::size_t bytes = std::strtoull(conn.in.c_str() + space + 1, nullptr, 10);
+                if (conn.in.size() < eol + 2 + bytes + 2) {
+                    break;
+                }
+                conn.hit = true;
+                pos = eol + 2 + bytes + 2;
+                continue;
+            }
+
+            Connection::Sent sent = conn.sent.front();
+            conn.sent.pop_front();
+            auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent.at);
+            _report.latency.Record(latency.count());
+            if (sent.get) {
+                _report.gets++;
+                _report.hits += conn.hit;
+                _report.errors += conn.in.compare(pos, eol - pos, "END") != 0;
+            } else {
+                _report.sets++;
+                _report.errors += conn.in.compare(pos, eol - pos, "STORED") != 0;
+            }
+            conn.hit = false;
+            pos = eol + 2;
+        }
+        conn.in.erase(0, pos);
+    }
+
+    const Options &_options;
+    const Zipf &_keys;
+    std::mt19937 _rnd;
+    std::string _value;
+
+    int _epoll;
+    std::vector<std::unique_ptr<Connection>> _connections;
+
+    Report _report;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options parser("afina-bench", "Load generator for memcached text protocol servers");
+    Options options;
+    try {
+        parser.add_options()("a,address", "Server address",
+                             cxxopts::value<std::string>(options.host)->default_value("127.0.0.1"));
+        parser.add_options()("p,port", "Server port", cxxopts::value<uint16_t>(options.port)->default_value("8080"));
+        parser.add_options()("c,connections", "Number of persistent connections",
+                             cxxopts::value<unsigned>(options.connections)->default_value("50"));
+        parser.add_options()("t,threads", "Number of threads connections are spread over",
+                             cxxopts::value<unsigned>(options.threads)->default_value("1"));
+        parser.add_options()("d,depth", "Number of requests each connection keeps in flight",
+                             cxxopts::value<unsigned>(options.pipeline)->default_value("8"));
+        parser.add_options()("duration", "Seconds to run",
+                             cxxopts::value<double>(options.duration)->default_value("10"));
+        parser.add_options()("r,ratio", "Share of gets among the requests",
+                             cxxopts::value<double>(options.get_ratio)->default_value("0.9"));
+        parser.add_options()("k,keys", "Number of keys",
+                             cxxopts::value<unsigned>(options.keys)->default_value("100000"));
+        parser.add_options()("v,value", "Size of the values set",
+                             cxxopts::value<unsigned>(options.value_size)->default_value("32"));
+        parser.add_options()("z,zipf", "Exponent of key popularity distribution, 0 for uniform",
+                             cxxopts::value<double>(options.zipf)->default_value("0.99"));
+        parser.add_options()("h,help", "Print usage info");
+        parser.parse(argc, argv);
+
+        if (parser.count("help") > 0) {
+            std::cerr << parser.help() << std::endl;
+            return 0;
+        }
+        if (options.connections == 0 || options.threads == 0 || options.pipeline == 0 || options.keys == 0) {
+            throw cxxopts::OptionParseException("connections, threads, depth and keys must be positive");
+        }
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    try {
+        Zipf keys(options.keys, options.zipf);
+        options.threads = std::min(options.threads, options.connections);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (unsigned i = 0; i < options.threads; i++) {
+            unsigned connections = options.connections / options.threads + (i < options.connections % options.threads);
+            workers.emplace_back(new Worker(options, keys, connections, 42 + i));
+        }
+
+        auto begin = Clock::now();
+        auto deadline =
+            begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> failures(workers.size());
+        for (std::size_t i = 0; i < workers.size(); i++) {
+            threads.emplace_back([&, i] {
+                try {
+                    workers[i]->Run(deadline);
+                } catch (...) {
+                    failures[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        for (auto &failure : failures) {
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        Report total;
+        for (auto &worker : workers) {
+            const Report &report = worker->Result();
+            total.latency.Merge(report.latency);
+            total.gets += report.gets;
+            total.hits += report.hits;
+            total.sets += report.sets;
+            total.errors += report.errors;
+        }
+
+        printf("%u connections, %u threads, %u requests in flight per connection, %.1f s\n", options.connections,
+               options.threads, options.pipeline, seconds);
+        printf("requests:   %llu (%.0f per second)\n", (unsigned long long)total.latency.Total(),
+               total.latency.Total() / seconds);
+        printf("gets:       %llu, %.1f%% hits\n", (unsigned long long)total.gets,
+               total.gets == 0 ? 0.0 : 100.0 * total.hits / total.gets);
+        printf("sets:       %llu\n", (unsigned long long)total.sets);
+        printf("errors:     %llu\n", (unsigned long long)total.errors);
+        printf("latency, us:");
+        for (double p : {0.5, 0.9, 0.99, 0.999, 0.9999}) {
+            printf(" p%g=%.1f", p * 100, total.latency.Percentile(p) / 1000.0);
+        }
+        printf(" max=%.1f\n", total.latency.Max() / 1000.0);
+    } catch (std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
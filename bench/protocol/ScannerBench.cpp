@@ -0,0 +1,132 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <afina/execute/Command.h>
+#include <afina/execute/Request.h>
+#include <protocol/Parser.h>
+#include <protocol/Scanner.h>
+#include <protocol/TextParser.h>
+
+using namespace Afina;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Pipelined traffic of a typical cache client: mostly gets of one to three keys, sometimes a set with
+// value of a few hundred bytes
+std::string make_traffic(std::size_t size) {
+    std::mt19937 rnd(42);
+    std::string result;
+    char key[32];
+    while (result.size() < size) {
+        if (rnd() % 10 != 0) {
+            result += "get";
+            for (unsigned i = 0, n = 1 + rnd() % 3; i < n; i++) {
+                snprintf(key, sizeof(key), " user:%08u", unsigned(rnd() % 100000000));
+                result += key;
+            }
+            result += "\r\n";
+        } else {
+            snprintf(key, sizeof(key), "user:%08u", unsigned(rnd() % 100000000));
+            std::size_t value = 32 + rnd() % 480;
+            result += "set " + std::string(key) + " 0 0 " + std::to_string(value) + "\r\n";
+            result += std::string(value, 'v') + "\r\n";
+        }
+    }
+    return result;
+}
+
+// Runs function given number of times, returns throughput in MB/s of the best run
+template <typename F> double measure(const std::string &traffic, int runs, F func) {
+    double best = 0;
+    for (int i = 0; i < runs; i++) {
+        auto begin = Clock::now();
+        func();
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        best = std::max(best, traffic.size() / seconds / (1024 * 1024));
+    }
+    return best;
+}
+
+// Splits traffic into lines, roughly what framing costs without any parsing
+std::size_t count_lines(const std::string &traffic, Protocol::Scanner::Mode mode) {
+    std::size_t lines = 0;
+    const char *pos = traffic.data(), *end = pos + traffic.size();
+    while ((pos = Protocol::Scanner::Find(mode, pos, end, '\n')) != end) {
+        lines++;
+        pos++;
+    }
+    return lines;
+}
+
+std::size_t count_lines_memchr(const std::string &traffic) {
+    std::size_t lines = 0;
+    const char *pos = traffic.data(), *end = pos + traffic.size();
+    while ((pos = static_cast<const char *>(std::memchr(pos, '\n', end - pos))) != nullptr) {
+        lines++;
+        pos++;
+    }
+    return lines;
+}
+
+// Builds command the way its users do: Parser allocates a new one, TextParser fills reused request in
+void build(Protocol::Parser &parser, Execute::Request &request, std::size_t &body) {
+    std::unique_ptr<Execute::Command> cmd = parser.Build(body);
+}
+
+void build(Protocol::TextParser &parser, Execute::Request &request, std::size_t &body) { parser.Build(request, body); }
+
+// Parses every command out of traffic read in chunks of the given size, the way network loops do
+template <typename P> std::size_t parse_all(const std::string &traffic, std::size_t chunk) {
+    P parser;
+    Execute::Request request;
+    std::size_t commands = 0, body = 0, pos = 0;
+    while (pos < traffic.size()) {
+        std::size_t parsed = 0;
+        std::size_t size = std::min(chunk - pos % chunk, traffic.size() - pos);
+        if (parser.Parse(traffic.data() + pos, size, parsed)) {
+            build(parser, request, body);
+            commands++;
+            pos += parsed + (body > 0 ? body + 2 : 0);
+            parser.Reset();
+        } else {
+            pos += parsed;
+        }
+    }
+    return commands;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string traffic = make_traffic(64 * 1024 * 1024);
+    const int runs = 5;
+    std::size_t sink = 0;
+
+    printf("Traffic: %zu bytes, best scanner: %s\n\n", traffic.size(),
+           Protocol::Scanner::Name(Protocol::Scanner::Best()));
+
+    printf("%-28s %10s\n", "line framing", "MB/s");
+    const Protocol::Scanner::Mode modes[] = {Protocol::Scanner::Mode::Scalar, Protocol::Scanner::Mode::SSE2,
+                                             Protocol::Scanner::Mode::AVX2};
+    for (auto mode : modes) {
+        if (Protocol::Scanner::Supported(mode)) {
+            double speed = measure(traffic, runs, [&] { sink += count_lines(traffic, mode); });
+            printf("%-28s %10.1f\n", Protocol::Scanner::Name(mode), speed);
+        }
+    }
+    printf("%-28s %10.1f\n\n", "memchr", measure(traffic, runs, [&] { sink += count_lines_memchr(traffic); }));
+
+    // Network servers read up to a buffer block at a time
+    printf("%-28s %10s\n", "parse, 4k reads", "MB/s");
+    printf("%-28s %10.1f\n", "Parser", measure(traffic, runs, [&] { sink += parse_all<Protocol::Parser>(traffic, 4096); }));
+    printf("%-28s %10.1f\n", "TextParser",
+           measure(traffic, runs, [&] { sink += parse_all<Protocol::TextParser>(traffic, 4096); }));
+
+    return sink == 0;
+}
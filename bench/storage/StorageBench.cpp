@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <common/Bench.h>
+#include <storage/SimpleLRU.h>
+#include <storage/ThreadSafeSimpleLRU.h>
+
+using namespace Afina;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Storage implementations under test. Backends which aren't thread safe are measured single threaded only
+struct Target {
+    const char *name;
+    bool thread_safe;
+    std::function<std::unique_ptr<Storage>(std::size_t max_size)> create;
+};
+
+const Target targets[] = {
+    {"SimpleLRU", false, [](std::size_t size) { return std::unique_ptr<Storage>(new Backend::SimpleLRU(size)); }},
+    {"ThreadSafeSimplLRU", true,
+     [](std::size_t size) { return std::unique_ptr<Storage>(new Backend::ThreadSafeSimplLRU(size)); }},
+};
+
+enum class Distribution { Uniform, Zipf };
+
+// Share of gets, puts and deletes, in percents
+struct Workload {
+    const char *name;
+    unsigned get;
+    unsigned put;
+};
+
+const Workload get_only = {"get", 100, 0};
+const Workload put_only = {"put", 0, 100};
+const Workload mixed = {"90/9/1", 90, 9};
+
+struct Sizes {
+    std::size_t key;
+    std::size_t value;
+    std::size_t keys;
+};
+
+const Sizes sizes[] = {{16, 32, 100000}, {32, 512, 100000}, {32, 4096, 10000}};
+
+struct Config {
+    const Target *target;
+    Distribution distribution;
+    Sizes sizes;
+    Workload workload;
+    unsigned threads;
+
+    // Percent of the keys stored before the run, so roughly the share of gets that hit
+    unsigned hit;
+};
+
+// Operation is chosen and its key generated before the run, so that only storage is measured
+struct Op {
+    uint32_t key;
+    uint8_t kind;
+};
+
+const std::size_t ops_per_thread = 200000;
+
+std::vector<Op> make_ops(const Config &config, unsigned seed) {
+    std::mt19937 rnd(seed);
+    std::uniform_int_distribution<uint32_t> uniform(0, config.sizes.keys - 1);
+    std::unique_ptr<Bench::Zipf> zipf;
+    if (config.distribution == Distribution::Zipf) {
+        zipf.reset(new Bench::Zipf(config.sizes.keys));
+    }
+
+    std::vector<Op> result(ops_per_thread);
+    for (auto &op : result) {
+        op.key = zipf ? (*zipf)(rnd) : uniform(rnd);
+        unsigned p = rnd() % 100;
+        op.kind = p < config.workload.get ? 0 : p < config.workload.get + config.workload.put ? 1 : 2;
+    }
+    return result;
+}
+
+struct Result {
+    double mops;
+    double hit;
+    uint64_t p50, p99, p999;
+};
+
+Result run(const Config &config) {
+    // Storage is large enough to keep every key, eviction has its own cost that isn't measured here
+    std::size_t max_size = config.sizes.keys * (config.sizes.key + config.sizes.value + 2) * 2;
+    std::unique_ptr<Storage> storage = config.target->create(max_size);
+
+    std::vector<std::string> keys(config.sizes.keys);
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        keys[i] = "key:" + std::to_string(i);
+        keys[i].resize(config.sizes.key, '.');
+    }
+    std::string value(config.sizes.value, 'v');
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (i * 7919 % 100 < config.hit) {
+            storage->Put(keys[i], value);
+        }
+    }
+
+    std::vector<std::vector<Op>> ops;
+    for (unsigned t = 0; t < config.threads; t++) {
+        ops.push_back(make_ops(config, 42 + t));
+    }
+
+    // Latency of every operation, clock overhead of a few tens of nanoseconds included
+    std::vector<std::vector<uint64_t>> latencies(config.threads, std::vector<uint64_t>(ops_per_thread));
+    std::vector<std::size_t> gets(config.threads), hits(config.threads);
+    std::promise<void> go;
+    std::shared_future<void> started = go.get_future().share();
+
+    auto worker = [&](unsigned t) {
+        std::string out;
+        std::size_t n_gets = 0, n_hits = 0;
+        started.wait();
+        for (std::size_t i = 0; i < ops_per_thread; i++) {
+            const Op &op = ops[t][i];
+            auto begin = Clock::now();
+            if (op.kind == 0) {
+                n_gets++;
+                n_hits += storage->Get(keys[op.key], out);
+            } else if (op.kind == 1) {
+                storage->Put(keys[op.key], value);
+            } else {
+                storage->Delete(keys[op.key]);
+            }
+            latencies[t][i] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+        }
+        gets[t] = n_gets;
+        hits[t] = n_hits;
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < config.threads; t++) {
+        threads.emplace_back(worker, t);
+    }
+    auto begin = Clock::now();
+    go.set_value();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::vector<uint64_t> all;
+    all.reserve(config.threads * ops_per_thread);
+    std::size_t total_gets = 0, total_hits = 0;
+    for (unsigned t = 0; t < config.threads; t++) {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        total_gets += gets[t];
+        total_hits += hits[t];
+    }
+
+    auto percentile = [&all](double p) {
+        auto it = all.begin() + std::size_t(p * (all.size() - 1));
+        std::nth_element(all.begin(), it, all.end());
+        return *it;
+    };
+
+    Result result;
+    result.mops = all.size() / seconds / 1e6;
+    result.hit = total_gets == 0 ? 0 : 100.0 * total_hits / total_gets;
+    result.p50 = percentile(0.5);
+    result.p99 = percentile(0.99);
+    result.p999 = percentile(0.999);
+    return result;
+}
+
+void header(const char *title) {
+    printf("\n%s\n", title);
+    printf("%-20s %-7s %5s %6s %-7s %7s %8s %6s %8s %8s %8s\n", "backend", "keys", "key", "value", "ops", "threads",
+           "Mops/s", "hit%", "p50 ns", "p99 ns", "p999 ns");
+}
+
+void report(const Config &config) {
+    Result r = run(config);
+    printf("%-20s %-7s %5zu %6zu %-7s %7u %8.2f %6.1f %8llu %8llu %8llu\n", config.target->name,
+           config.distribution == Distribution::Zipf ? "zipf" : "uniform", config.sizes.key, config.sizes.value,
+           config.workload.name, config.threads, r.mops, r.hit, (unsigned long long)r.p50, (unsigned long long)r.p99,
+           (unsigned long long)r.p999);
+    fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    printf("%zu operations per thread, storage never evicts\n", ops_per_thread);
+
+    header("Operations, single thread, 90% of keys stored");
+    for (auto &target : targets) {
+        for (auto distribution : {Distribution::Uniform, Distribution::Zipf}) {
+            for (auto &size : sizes) {
+                for (auto &workload : {get_only, put_only, mixed}) {
+                    report({&target, distribution, size, workload, 1, 90});
+                }
+            }
+        }
+    }
+
+    header("Hit ratio, gets only");
+    for (auto &target : targets) {
+        for (unsigned hit : {10, 50, 100}) {
+            report({&target, Distribution::Zipf, sizes[1], get_only, 1, hit});
+        }
+    }
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    header("Threads, 90% of keys stored");
+    for (auto &target : targets) {
+        if (!target.thread_safe) {
+            continue;
+        }
+        for (auto distribution : {Distribution::Uniform, Distribution::Zipf}) {
+            for (unsigned threads = 1; threads <= std::min(cores, 8u); threads *= 2) {
+                report({&target, distribution, sizes[1], mixed, threads, 90});
+            }
+        }
+    }
+    return 0;
+}
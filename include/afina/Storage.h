@@ -1,6 +1,9 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 
 namespace Afina {
@@ -25,10 +28,14 @@ public:
      * method returns true any subsequent access to storage must indicates that
      * key->value association exists
      *
+     * Storage takes memory of the value over, so callers move large values received from network in
+     * to store them without a copy
+     *
      * @param key to be associated with value
      * @param value to be assigned for the key
+     * @param version if not null gets version the association got, see CompareAndSet. Zero if value isn't stored
      */
-    virtual bool Put(const std::string &key, const std::string &value) = 0;
+    virtual bool Put(const std::string &key, std::string value, uint64_t *version = nullptr) = 0;
 
     /**
      * Stores association between given key/value pair if key isn't present in
@@ -40,8 +47,9 @@ public:
      *
      * @param key to be associated with value
      * @param value to be assigned for the key
+     * @param version if not null gets version of the created association, see Put
      */
-    virtual bool PutIfAbsent(const std::string &key, const std::string &value) = 0;
+    virtual bool PutIfAbsent(const std::string &key, std::string value, uint64_t *version = nullptr) = 0;
 
     /**
      * Updates existing association between given key/value pair
@@ -53,8 +61,9 @@ public:
      *
      * @param key to be associated with value
      * @param value to be assigned for the key
+     * @param version if not null gets version the association got, see Put
      */
-    virtual bool Set(const std::string &key, const std::string &value) = 0;
+    virtual bool Set(const std::string &key, std::string value, uint64_t *version = nullptr) = 0;
 
     /**
      * Removes association for the given key
@@ -80,10 +89,115 @@ public:
      * In case if given key not found method returns false and doesn't perform
      * any changes on the output parameter
      *
+     * Each time association gets created or changed it is assigned a new
+     * version, which is never zero and never repeats, see CompareAndSet
+     *
      * @param key to retrive1 value for
      * @param value output parameter to copy value to
+     * @param version if not null gets version of the association
+     */
+    virtual bool Get(const std::string &key, std::string &value, uint64_t *version = nullptr) = 0;
+
+    /**
+     * Updates existing association only if nobody changed it since the
+     * given version was retrived
+     *
+     * If association is updated then method returns true and version gets
+     * the new one. Otherwise method returns false and version gets the
+     * current version of the association or zero if there is no such key
+     *
+     * @param key to be associated with value
+     * @param value to be assigned for the key
+     * @param version expected version of the association
+     */
+    virtual bool CompareAndSet(const std::string &key, std::string value, uint64_t &version) = 0;
+
+    /**
+     * Atomically updates value for the given key
+     * If requested key doesn't present in storage method returns false and
+     * doesn't call fn.
+     *
+     * Otherwise fn gets a copy of the current value and could change it in place.
+     * If fn returns true then changed value replaces the current one and gets
+     * a new version, nobody could change the association in between. If fn returns false the value
+     * stays as is. Method returns false if new value can't be stored, true
+     * otherwise.
+     *
+     * fn is called with the storage locked, so it must be short and must not
+     * access the storage itself
+     *
+     * @param key to update value for
+     * @param fn computes new value out of the current one
+     * @param version if not null gets version of the association afterwards, zero if key isn't found or new
+     * value can't be stored
+     */
+    virtual bool Update(const std::string &key, const std::function<bool(std::string &value)> &fn,
+                        uint64_t *version = nullptr) = 0;
+
+    /**
+     * Adds data to the end of the value for the given key. Last trim bytes of the value are cut off first,
+     * so data takes their place. Default goes through Update, storage that keeps values in pieces takes
+     * memory of the data over without rewriting the value
+     * If requested key doesn't present in storage method returns false and does nothing
+     *
+     * @param key
+     * @param data
+     * @param trim number of bytes to drop from the end of the existing value
+     * @param version if not null gets version the association got, see Put
+     * @return true if value has been changed
+     */
+    virtual bool Append(const std::string &key, std::string data, std::size_t trim, uint64_t *version = nullptr) {
+        auto append = [&data, trim](std::string &value) {
+            value.resize(value.size() > trim ? value.size() - trim : 0);
+            value += data;
+            return true;
+        };
+        return Update(key, append, version);
+    }
+
+    /**
+     * Adds data to the start of the value for the given key, see Append
+     * If requested key doesn't present in storage method returns false and does nothing
+     *
+     * @param key
+     * @param data
+     * @param version if not null gets version the association got, see Put
+     * @return true if value has been changed
+     */
+    virtual bool Prepend(const std::string &key, std::string data, uint64_t *version = nullptr) {
+        auto prepend = [&data](std::string &value) {
+            value.insert(0, data);
+            return true;
+        };
+        return Update(key, prepend, version);
+    }
+
+    /**
+     * Marks association for the given key as recently used without reading its value. Default goes through
+     * Update, storage that keeps usage order does it without copying the value
+     * If requested key doesn't present in storage method returns false
+     *
+     * @param key
+     * @return true if association exists
+     */
+    virtual bool Touch(const std::string &key) {
+        return Update(key, [](std::string &value) { return false; });
+    }
+
+    /**
+     * Removes all associations
+     */
+    virtual void Clear() = 0;
+
+    /**
+     * Runs several operations at once
+     * fn gets the storage it must use for all its operations, synchronized
+     * storages lock themselves once and pass the underlying one, so fn
+     * must be short and must not use any other storage reference
+     *
+     * @param fn operations to run
      */
-    virtual bool Get(const std::string &key, std::string &value) = 0;
+    virtual void Batch(const std::function<void(Storage &storage)> &fn) { fn(*this); }
 };
 
 } // namespace Afina
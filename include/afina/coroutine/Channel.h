@@ -0,0 +1,107 @@
+#ifndef AFINA_COROUTINE_CHANNEL_H
+#define AFINA_COROUTINE_CHANNEL_H
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Sync.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Bounded queue between coroutines
+ * Send blocks current coroutine while channel is full, Receive blocks while it is empty. Once closed,
+ * channel rejects new values, but those already inside still could be received.
+ *
+ * Bound to a single engine, just like other primitives in Sync.h
+ */
+template <typename T> class Channel {
+public:
+    Channel(Engine &engine, std::size_t capacity)
+        : _capacity(capacity > 0 ? capacity : 1), _closed(false), _senders(engine), _receivers(engine) {}
+
+    /**
+     * Puts value into the channel, waiting for free space if necessary. Returns false if channel is closed
+     */
+    bool Send(T value) {
+        while (!_closed && _items.size() >= _capacity) {
+            _senders.Wait();
+        }
+        return _put(std::move(value));
+    }
+
+    /**
+     * Puts value into the channel only if there is free space right now
+     */
+    bool TrySend(T value) {
+        if (_items.size() >= _capacity) {
+            return false;
+        }
+        return _put(std::move(value));
+    }
+
+    /**
+     * Takes value from the channel, waiting for it if necessary. Returns false if channel is closed and empty
+     */
+    bool Receive(T &value) {
+        while (!_closed && _items.empty()) {
+            _receivers.Wait();
+        }
+        return _take(value);
+    }
+
+    /**
+     * Takes value from the channel only if there is one right now
+     */
+    bool TryReceive(T &value) { return _take(value); }
+
+    /**
+     * Rejects all future values and wakes everyone waiting on the channel
+     */
+    void Close() {
+        _closed = true;
+        _senders.NotifyAll();
+        _receivers.NotifyAll();
+    }
+
+    inline bool Closed() const { return _closed; }
+    inline std::size_t Size() const { return _items.size(); }
+    inline std::size_t Capacity() const { return _capacity; }
+
+private:
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    bool _put(T &&value) {
+        if (_closed) {
+            return false;
+        }
+        _items.push_back(std::move(value));
+        _receivers.NotifyOne();
+        return true;
+    }
+
+    bool _take(T &value) {
+        if (_items.empty()) {
+            return false;
+        }
+        value = std::move(_items.front());
+        _items.pop_front();
+        _senders.NotifyOne();
+        return true;
+    }
+
+    std::size_t _capacity;
+    bool _closed;
+    std::deque<T> _items;
+    WaitQueue _senders;
+    WaitQueue _receivers;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_CHANNEL_H
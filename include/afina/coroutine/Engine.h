@@ -1,6 +1,9 @@
 #ifndef AFINA_COROUTINE_ENGINE_H
 #define AFINA_COROUTINE_ENGINE_H
 
+#include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -8,6 +11,9 @@
 #include <map>
 #include <setjmp.h>
 #include <tuple>
+#include <utility>
+
+#include <afina/coroutine/StackPool.h>
 
 namespace Afina {
 namespace Coroutine {
@@ -18,11 +24,68 @@ namespace Coroutine {
  */
 class Engine final {
 public:
+    /**
+     * Where coroutines keep their stacks
+     */
+    enum class StackMode {
+        // All coroutines run on the thread stack. On each switch active part of the stack gets copied
+        // into the context and back, so switch costs proportional to the call depth
+        Copy,
+
+        // Each coroutine owns a separate mmap'ed stack protected by a guard page, switch only swaps
+        // registers and costs the same regardless of call depth. See SeparateStackSupported()
+        Separate
+    };
+
+    /**
+     * Default size of coroutine stack in Separate mode, guard page is not included
+     */
+    static constexpr std::size_t DefaultStackSize = 64 * 1024;
+
+    /**
+     * Returns true if Separate stack mode is implemented for the current platform
+     */
+    static bool SeparateStackSupported();
+
+    /**
+     * Number of direct handoffs coroutine is allowed to make before its successors have to wait in the run
+     * queue like everyone else, see Handoff()
+     */
+    static constexpr unsigned DefaultQuantum = 8;
+
+    /**
+     * Scheduler counters, switch rate could be derived from two snapshots taken some time apart
+     */
+    struct Stats {
+        // Context switches made since the engine has been created
+        std::uint64_t switches;
+
+        // Coroutines ready to run, the running one included
+        std::size_t runnable;
+
+        // Highest number of runnable coroutines seen so far
+        std::size_t max_runnable;
+
+        // Coroutines waiting to be woken up
+        std::size_t blocked;
+    };
+
+    /**
+     * Clock all timers are measured with
+     */
+    typedef std::chrono::steady_clock Clock;
+
+    struct context;
+
+    /**
+     * Blocked coroutines with deadline, ordered by deadline
+     */
+    typedef std::multimap<Clock::time_point, context *> Timers;
+
     /**
      * A single coroutine instance which could be scheduled for execution
      * should be allocated on heap
      */
-    struct context;
     typedef struct context {
         // coroutine stack start address
         char *Low = nullptr;
@@ -36,12 +99,33 @@ public:
         // Saved coroutine context (registers)
         jmp_buf Environment;
 
+        // Separate stack mode: saved stack pointer, registers are stored on the stack itself
+        void *Sp = nullptr;
+
+        // Separate stack mode: mapped stack region, guard page included
+        char *StackMemory = nullptr;
+        size_t StackMemorySize = 0;
+
+        // Function coroutine runs. Kept here rather than on the stack: in Copy mode stack copy preserves
+        // std::function object itself, but not the heap memory it might own
+        std::function<void()> Entry;
+
         // To include routine in the different lists, such as "alive", "blocked", e.t.c
         struct context *prev = nullptr;
         struct context *next = nullptr;
 
         // blocked status of coroutine
         bool blocked = false;
+
+        // Handoffs left before coroutine has to go through the run queue, see Handoff()
+        unsigned Quantum = 0;
+
+        // Deadline of the current block if there is any
+        bool HasTimer = false;
+        Timers::iterator Timer;
+
+        // Whether the last block has finished due to deadline
+        bool TimedOut = false;
     } context;
 
 private:
@@ -56,9 +140,11 @@ private:
     context *cur_routine;
 
     /**
-     * List of routines ready to be scheduled. Note that suspended routine ends up here as well
+     * FIFO queue of routines ready to be scheduled, head runs next. Note that running routine stays
+     * in the queue as well
      */
     context *alive;
+    context *alive_tail;
 
     /**
      * Context to be returned finally
@@ -72,6 +158,68 @@ private:
 
     std::function<void()> idle_func;
 
+    /**
+     * Where coroutines keep their stacks
+     */
+    StackMode _mode;
+
+    /**
+     * Size of a coroutine stack in Separate mode
+     */
+    std::size_t _stack_size;
+
+    /**
+     * Separate stack mode: finished coroutine which stack is still to be released. Coroutine can't
+     * unmap the stack it runs on, so that is done by the next one getting control
+     */
+    context *_zombie;
+
+    /**
+     * Number of context switches made so far, lets idle loop see whether idle function has passed control
+     * to anyone
+     */
+    std::uint64_t _switches;
+
+    /**
+     * Lengths of the lists, see Stats
+     */
+    std::size_t _runnable;
+    std::size_t _max_runnable;
+    std::size_t _blocked;
+
+    /**
+     * Memory of finished coroutines: stack buffers and stacks get cached in the pool, contexts in the list
+     * linked through the next pointer
+     */
+    StackPool _pool;
+    context *_free_contexts;
+    std::size_t _free_contexts_count;
+    std::size_t _max_cached;
+
+    /**
+     * Deadlines of blocked coroutines
+     */
+    Timers _timers;
+
+    /**
+     * Function call with bound arguments. Arguments passed as lvalues are bound by reference, rvalues
+     * are moved inside
+     */
+    template <std::size_t... I> struct Sequence {};
+    template <std::size_t N, std::size_t... I> struct Indexes : Indexes<N - 1, N - 1, I...> {};
+    template <std::size_t... I> struct Indexes<0, I...> { typedef Sequence<I...> type; };
+
+    template <typename... Ta> struct Invocation {
+        Invocation(void (*func)(Ta...), Ta &&... args) : func(func), args(std::forward<Ta>(args)...) {}
+
+        void operator()() { call(typename Indexes<sizeof...(Ta)>::type()); }
+
+        template <std::size_t... I> void call(Sequence<I...>) { func(std::forward<Ta>(std::get<I>(args))...); }
+
+        void (*func)(Ta...);
+        std::tuple<Ta...> args;
+    };
+
 protected:
     /**
      * Save stack of the current coroutine in the given context
@@ -89,20 +237,72 @@ protected:
     void Enter(context &ctx);
 
     /**
-     * Move coroutine from one list to another
-     * This function assumes, that routine is in fromlist and not in tolist (not sure about the latter)
+     * Put coroutine into the run queue, to the tail or, if front is true, to the head
+     */
+    void Enqueue(context *routine, bool front = false);
+
+    /**
+     * Remove coroutine from the run queue
      */
-    void MoveCoroutine(context *&fromlist, context *&tolist, context *routine);
+    void Dequeue(context *routine);
+
+    /**
+     * Add coroutine to the list of blocked ones and remove it from there
+     */
+    void PushBlocked(context *routine);
+    void RemoveBlocked(context *routine);
+
+    /**
+     * Returns fresh context, either cached one or newly allocated
+     */
+    context *NewContext();
+
+    /**
+     * Releases context together with its stack memory, both could be reused by coroutines started later
+     */
+    void DeleteContext(context *ctx);
+
+    /**
+     * Separate stack mode: creates coroutine with its own stack which is going to run given function
+     */
+    void *Spawn(std::function<void()> &&func);
+
+    /**
+     * Separate stack mode: entry point of every coroutine, runs on the coroutine stack
+     */
+    static void Trampoline(Engine *engine, context *ctx);
+
+    /**
+     * Separate stack mode: releases stack of the finished coroutine if there is any
+     */
+    void Collect();
+
+    /**
+     * Separate stack mode: schedules coroutines starting from the given one until all are done
+     * or idle function has nothing to wake up
+     */
+    void Loop(void *pc);
 
 public:
-    Engine()
-        : StackBottom(0), idle_func([]() {}), cur_routine(nullptr), alive(nullptr), blocked(nullptr),
-          idle_ctx(nullptr) {}
-    Engine(std::function<void()> _idle_func)
-        : StackBottom(0), idle_func(_idle_func), cur_routine(nullptr), alive(nullptr), blocked(nullptr),
-          idle_ctx(nullptr) {}
+    /**
+     * Default number of finished coroutine contexts, and stacks of every size, kept for reuse
+     */
+    static constexpr std::size_t DefaultMaxCached = 64;
+
+    Engine(StackMode mode = StackMode::Copy, std::size_t stack_size = DefaultStackSize,
+           std::size_t max_cached = DefaultMaxCached)
+        : Engine([]() {}, mode, stack_size, max_cached) {}
+    Engine(std::function<void()> _idle_func, StackMode mode = StackMode::Copy,
+           std::size_t stack_size = DefaultStackSize, std::size_t max_cached = DefaultMaxCached);
     Engine(Engine &&) = delete;
     Engine(const Engine &) = delete;
+    ~Engine();
+
+    /**
+     * Allocates memory for given number of coroutines in advance, so that the first ones to start don't
+     * pay for that. Number of prepared coroutines is limited by the cache size
+     */
+    void Prewarm(std::size_t coroutines);
 
     /**
      * Check if all the coroutines are blocked
@@ -118,12 +318,9 @@ public:
     context *get_cur_routine() const;
 
     /**
-     * Gives up current routine execution and let engine to schedule other one. It is not defined when
-     * routine will get execution back, for example if there are no other coroutines then executing could
-     * be trasferred back immediately (yield turns to be noop).
-     *
-     * Also there are no guarantee what coroutine will get execution, it could be caller of the current one or
-     * any other which is ready to run
+     * Gives up current routine execution and let engine to schedule other one. Routines are served round
+     * robin: current one goes to the tail of the run queue and gets execution back once everyone ready to
+     * run before it has got its turn. If there are no other coroutines then yield turns to be noop
      */
     void yield();
 
@@ -144,32 +341,85 @@ public:
     void Block();
 
     /**
-     * Wake given coroutine (move from blocked to alive),
+     * Wake given coroutine (move from blocked to the tail of the run queue),
      * mark as not blocked
      */
     void Wake(context *ctx);
 
+    /**
+     * Wake given coroutine and make it the next one to run: control goes to it as soon as the current
+     * coroutine yields or blocks, before anyone else waiting in the queue. Woken coroutine inherits
+     * the rest of the waker quantum, so a chain of coroutines handing off to each other can't starve the
+     * queue: once quantum is over Handoff works as Wake
+     */
+    void Handoff(context *ctx);
+
     /**
      * Wake all the coroutines in blocked
      * Required when the server is going to stop.
      */
     void WakeAll(void);
 
+    /**
+     * Block current coroutine until woken up or deadline passes, whatever happens first. Returns false
+     * if deadline has passed.
+     *
+     * Timers are served by the idle loop: in Separate mode engine does it on its own, custom idle function
+     * has to call WakeExpired() and could use NextTimeout() to learn how long it is allowed to wait
+     */
+    bool BlockUntil(Clock::time_point deadline);
+
+    /**
+     * Suspends current coroutine for the given time. Could return earlier if coroutine gets woken up
+     * explicitly, for example by WakeAll()
+     */
+    template <typename Rep, typename Period> void sleep_for(const std::chrono::duration<Rep, Period> &duration) {
+        BlockUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+    }
+
+    /**
+     * Wakes all coroutines which deadline has passed
+     */
+    void WakeExpired();
+
+    /**
+     * Milliseconds left till the nearest deadline rounded up, 0 if some already passed, -1 if there
+     * is no deadline at all. Suitable as a timeout for epoll_wait and friends
+     */
+    int NextTimeout() const;
+
+    /**
+     * Current scheduler counters, takes constant time
+     */
+    Stats GetStats() const;
+
     /**
      * Entry point into the engine. Prepare all internal mechanics and starts given function which is
      * considered as main.
      *
      * Once control returns back to caller of start all coroutines are done execution, in other words,
      * this function doesn't return control until all coroutines are done.
+     *
+     * Engine has no way to unwind stack of a coroutine, so callers must not leave coroutines blocked once
+     * idle function has nothing to wake them with: wake everyone on shutdown, see WakeAll(), and let them
+     * return. That is asserted in debug builds
      */
     template <typename... Ta> void start(void (*main)(Ta...), Ta &&... args) {
         // To acquire stack begin, create variable on stack and remember its address
         char StackStartsHere;
         this->StackBottom = &StackStartsHere;
 
+        if (_mode == StackMode::Separate) {
+            // Thread stack becomes stack of the idle context
+            idle_ctx = NewContext();
+            cur_routine = idle_ctx;
+            Loop(run(main, std::forward<Ta>(args)...));
+            return;
+        }
+
         // Start routine execution
         void *pc = run(main, std::forward<Ta>(args)...);
-        idle_ctx = new context();
+        idle_ctx = NewContext();
 
         if (setjmp(idle_ctx->Environment) > 0) {
             // Here: correct finish of the coroutine section
@@ -181,8 +431,11 @@ public:
 
         idle_func();
         // Shutdown runtime
-        delete std::get<0>(idle_ctx->Stack);
-        delete idle_ctx;
+        assert(blocked == nullptr && "coroutines left blocked once engine has run out of work");
+        _timers.clear();
+        DeleteContext(idle_ctx);
+        idle_ctx = nullptr;
+        cur_routine = nullptr;
         this->StackBottom = 0;
     }
 
@@ -191,9 +444,17 @@ public:
         char StackStartsHere;
         this->StackBottom = &StackStartsHere;
 
+        if (_mode == StackMode::Separate) {
+            // Thread stack becomes stack of the idle context
+            idle_ctx = NewContext();
+            cur_routine = idle_ctx;
+            Loop(run_noargs(main));
+            return;
+        }
+
         // Start routine execution
         void *pc = run_noargs(main);
-        idle_ctx = new context();
+        idle_ctx = NewContext();
 
         if (setjmp(idle_ctx->Environment) > 0) {
             // Here: correct finish of the coroutine section
@@ -205,8 +466,11 @@ public:
 
         idle_func();
         // Shutdown runtime
-        delete std::get<0>(idle_ctx->Stack);
-        delete idle_ctx;
+        assert(blocked == nullptr && "coroutines left blocked once engine has run out of work");
+        _timers.clear();
+        DeleteContext(idle_ctx);
+        idle_ctx = nullptr;
+        cur_routine = nullptr;
         this->StackBottom = 0;
     }
 
@@ -220,8 +484,12 @@ public:
             return nullptr;
         }
 
+        if (_mode == StackMode::Separate) {
+            return Spawn(Invocation<Ta...>(func, std::forward<Ta>(args)...));
+        }
+
         // New coroutine context that carries around all information enough to call function
-        context *pc = new context();
+        context *pc = NewContext();
 
         // Store current state right here, i.e just before enter new coroutine, later, once it gets scheduled
         // execution starts here. Note that we have to acquire stack of the current function call to ensure
@@ -237,25 +505,11 @@ public:
             // to pass control after that. We never want to go backward by stack as that would mean to go backward in
             // time. Function run() has already return once (when setjmp returns 0), so return second return from run
             // would looks a bit awkward
-            if (pc->prev != nullptr) {
-                pc->prev->next = pc->next;
-            }
-
-            if (pc->next != nullptr) {
-                pc->next->prev = pc->prev;
-            }
-
-            if (alive == cur_routine) {
-                alive = alive->next;
-            }
+            Dequeue(pc);
 
             // current coroutine finished, and the pointer is not relevant now
             cur_routine = nullptr;
-            pc->prev = pc->next = nullptr;
-            if (std::get<0>(pc->Stack) != nullptr) {
-                delete std::get<0>(pc->Stack);
-            }
-            delete pc;
+            DeleteContext(pc);
 
             // We cannot return here, as this function "returned" once already, so here we must select some other
             // coroutine to run. As current coroutine is completed and can't be scheduled anymore, it is safe to
@@ -268,13 +522,10 @@ public:
         // save stack.
         Store(*pc);
 
-        // Add routine as alive double-linked list
-        pc->next = alive;
+        // Routine is ready to run
         pc->blocked = false;
-        alive = pc;
-        if (pc->next != nullptr) {
-            pc->next->prev = pc;
-        }
+        pc->Quantum = DefaultQuantum;
+        Enqueue(pc);
 
         return pc;
     }
@@ -285,8 +536,14 @@ public:
             return nullptr;
         }
 
+        if (_mode == StackMode::Separate) {
+            return Spawn(std::move(func));
+        }
+
         // New coroutine context that carries around all information enough to call function
-        context *pc = new context();
+        context *pc = NewContext();
+
+        pc->Entry = std::move(func);
 
         // Store current state right here, i.e just before enter new coroutine, later, once it gets scheduled
         // execution starts here. Note that we have to acquire stack of the current function call to ensure
@@ -296,31 +553,18 @@ public:
             // context pointer, arguments and a pointer to the function comes from restored stack
 
             // invoke routine
-            func();
+            pc->Entry();
+            pc->Entry = nullptr;
 
             // Routine has completed its execution, time to delete it. Note that we should be extremely careful in where
             // to pass control after that. We never want to go backward by stack as that would mean to go backward in
             // time. Function run() has already return once (when setjmp returns 0), so return second return from run
             // would looks a bit awkward
-            if (pc->prev != nullptr) {
-                pc->prev->next = pc->next;
-            }
-
-            if (pc->next != nullptr) {
-                pc->next->prev = pc->prev;
-            }
-
-            if (alive == cur_routine) {
-                alive = alive->next;
-            }
+            Dequeue(pc);
 
             // current coroutine finished, and the pointer is not relevant now
             cur_routine = nullptr;
-            pc->prev = pc->next = nullptr;
-            if (std::get<0>(pc->Stack) != nullptr) {
-                delete std::get<0>(pc->Stack);
-            }
-            delete pc;
+            DeleteContext(pc);
 
             // We cannot return here, as this function "returned" once already, so here we must select some other
             // coroutine to run. As current coroutine is completed and can't be scheduled anymore, it is safe to
@@ -333,13 +577,10 @@ public:
         // save stack.
         Store(*pc);
 
-        // Add routine as alive double-linked list
-        pc->next = alive;
+        // Routine is ready to run
         pc->blocked = false;
-        alive = pc;
-        if (pc->next != nullptr) {
-            pc->next->prev = pc;
-        }
+        pc->Quantum = DefaultQuantum;
+        Enqueue(pc);
 
         return pc;
     }
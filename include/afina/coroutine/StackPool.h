@@ -0,0 +1,78 @@
+#ifndef AFINA_COROUTINE_STACK_POOL_H
+#define AFINA_COROUTINE_STACK_POOL_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Cache of coroutine stack memory
+ * Keeps two kinds of memory released by finished coroutines:
+ * - buffers for stack copies, grouped into power of two size classes
+ * - mmap'ed stacks with guard page
+ *
+ * Each size class caches a bounded number of entries, everything above the limit or larger than the
+ * biggest class goes back to the system. Not thread safe, every engine owns its own pool
+ */
+class StackPool {
+public:
+    // Smallest and biggest size class of copy buffers
+    static constexpr std::size_t MinBufferSize = 1024;
+    static constexpr std::size_t MaxBufferSize = 1024 * 1024;
+
+    explicit StackPool(std::size_t max_cached = 64);
+    ~StackPool();
+
+    /**
+     * Returns buffer able to keep at least size bytes
+     *
+     * @param size input: number of bytes required, output: actual size of the returned buffer
+     */
+    char *AcquireBuffer(std::size_t &size);
+
+    /**
+     * Returns buffer obtained with AcquireBuffer back to the pool
+     */
+    void ReleaseBuffer(char *buffer, std::size_t size);
+
+    /**
+     * Returns stack having at least size usable bytes, one more page below it is protected from any
+     * access to catch overflow
+     *
+     * @param size input: number of usable bytes required, output: size of the whole mapping
+     */
+    char *AcquireStack(std::size_t &size);
+
+    /**
+     * Returns mapping obtained with AcquireStack back to the pool
+     */
+    void ReleaseStack(char *stack, std::size_t size);
+
+    /**
+     * Number of buffers and stacks currently cached
+     */
+    std::size_t Cached() const;
+
+private:
+    StackPool(const StackPool &) = delete;
+    StackPool &operator=(const StackPool &) = delete;
+
+    // Index of the smallest size class fitting given size
+    static std::size_t _class(std::size_t size);
+
+    // Free buffers by size class, MinBufferSize << i bytes each
+    std::vector<std::vector<char *>> _buffers;
+
+    // Free stacks together with the size of their mappings
+    std::vector<std::pair<char *, std::size_t>> _stacks;
+
+    std::size_t _max_cached;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_STACK_POOL_H
@@ -0,0 +1,115 @@
+#ifndef AFINA_COROUTINE_SYNC_H
+#define AFINA_COROUTINE_SYNC_H
+
+#include <cstddef>
+#include <deque>
+
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Queue of coroutines waiting for something
+ * Base of all synchronization primitives: waiting coroutine gets parked in the engine blocked list, notify
+ * moves it back to alive in FIFO order. OS threads are never involved, so primitive must only be used by
+ * coroutines of the engine it is bound to.
+ *
+ * Wait could return without notification, for example after Engine::WakeAll, so caller must always recheck
+ * condition it waits for.
+ *
+ * In Copy stack mode all coroutines share the same stack memory, so primitives used by several coroutines
+ * must not live on the stack of any of them
+ */
+class WaitQueue {
+public:
+    explicit WaitQueue(Engine &engine) : _engine(engine) {}
+
+    /**
+     * Blocks current coroutine until notified
+     */
+    void Wait();
+
+    /**
+     * Wakes the longest waiting coroutine and hands control off to it, see Engine::Handoff. Returns false
+     * if there is nobody waiting
+     */
+    bool NotifyOne();
+
+    /**
+     * Wakes all waiting coroutines, they run in the order they started to wait
+     */
+    void NotifyAll();
+
+    inline bool Empty() const { return _waiters.empty(); }
+
+private:
+    WaitQueue(const WaitQueue &) = delete;
+    WaitQueue &operator=(const WaitQueue &) = delete;
+
+    Engine &_engine;
+    std::deque<Engine::context *> _waiters;
+};
+
+/**
+ * # Coroutine mutex
+ * Lock blocks current coroutine, not thread, while the mutex is owned by someone else
+ */
+class Mutex {
+public:
+    explicit Mutex(Engine &engine) : _locked(false), _waiters(engine) {}
+
+    void Lock();
+    bool TryLock();
+    void Unlock();
+
+    inline bool Locked() const { return _locked; }
+
+private:
+    bool _locked;
+    WaitQueue _waiters;
+};
+
+/**
+ * # One shot notification
+ * Once set, all current and future waiters pass through until Reset()
+ */
+class Event {
+public:
+    explicit Event(Engine &engine) : _set(false), _waiters(engine) {}
+
+    void Set();
+    void Reset() { _set = false; }
+    void Wait();
+
+    inline bool IsSet() const { return _set; }
+
+private:
+    bool _set;
+    WaitQueue _waiters;
+};
+
+/**
+ * # Waits for a group of coroutines to finish
+ * Counter gets increased by Add() before starting a job and decreased by Done() once job is finished, Wait()
+ * blocks until counter drops to zero
+ */
+class WaitGroup {
+public:
+    explicit WaitGroup(Engine &engine) : _counter(0), _waiters(engine) {}
+
+    void Add(std::size_t n = 1) { _counter += n; }
+    void Done();
+    void Wait();
+
+    inline std::size_t Count() const { return _counter; }
+
+private:
+    std::size_t _counter;
+    WaitQueue _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_SYNC_H
@@ -24,7 +24,13 @@ public:
     Append(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
     ~Append() {}
 
-    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    /**
+     * Executes the command with the given fields, without building the object. Memory of the data block
+     * is taken over by storage
+     */
+    static void Run(Storage &storage, const std::string &key, std::string &&args, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
 };
 
 } // namespace Execute
@@ -0,0 +1,46 @@
+#ifndef AFINA_EXECUTE_CAS_H
+#define AFINA_EXECUTE_CAS_H
+
+#include <cstdint>
+#include <string>
+
+#include "InsertCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Check and set
+ * Stores data for the key, but only if nobody updated it since the client
+ * last fetched it with Gets
+ *
+ * Command must write result to the output, which could be:
+ * - "STORED", to indicate success.
+ * - "EXISTS" to indicate that the item has been modified since the client
+ * fetched it
+ * - "NOT_FOUND" to indicate that the item doesn't exist
+ */
+class Cas : public InsertCommand {
+public:
+    Cas(const std::string &key, uint32_t flags, int32_t expire, uint64_t version)
+        : InsertCommand(key, flags, expire), _version(version) {}
+    ~Cas() {}
+
+    inline uint64_t version() const { return _version; }
+
+    /**
+     * Executes the command with the given fields, without building the object. Memory of the data block
+     * is taken over by storage
+     */
+    static void Run(Storage &storage, const std::string &key, uint64_t version, std::string &&args, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
+
+private:
+    const uint64_t _version;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_CAS_H
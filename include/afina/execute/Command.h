@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "Response.h"
+
 namespace Afina {
 
 class Storage;
@@ -10,15 +12,15 @@ class Storage;
 namespace Execute {
 
 /**
- *
- *
+ * # Command to be executed against storage
+ * Result of the execution is written into the response, without the final \r\n which network layer adds
  */
 class Command {
 public:
     Command() {}
     virtual ~Command() {}
 
-    virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
+    virtual void Execute(Storage &storage, const std::string &args, Response &out) = 0;
 };
 
 } // namespace Execute
@@ -0,0 +1,27 @@
+#ifndef AFINA_EXECUTE_DECR_H
+#define AFINA_EXECUTE_DECR_H
+
+#include <cstdint>
+#include <string>
+
+#include "Incr.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Decrement value for the key
+ * Same as Incr, but subtracts delta from the value. Counter never goes below
+ * zero, it stops there instead of wrapping around
+ */
+class Decr : public Incr {
+public:
+    Decr(const std::string &key, uint64_t delta) : Incr(key, delta, 0, false, true) {}
+    Decr(const std::string &key, uint64_t delta, uint64_t initial) : Incr(key, delta, initial, true, true) {}
+    ~Decr() {}
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_DECR_H
@@ -1,6 +1,8 @@
 #ifndef AFINA_EXECUTE_DELETE_H
 #define AFINA_EXECUTE_DELETE_H
 
+#include <string>
+
 #include "Command.h"
 
 namespace Afina {
@@ -17,10 +19,20 @@ namespace Execute {
  */
 class Delete : public Command {
 public:
-    Delete();
-    ~Delete();
+    Delete(const std::string &key) : _key(key) {}
+    ~Delete() {}
+
+    inline const std::string &key() const { return _key; }
+
+    /**
+     * Executes the command with the given fields, without building the object
+     */
+    static void Run(Storage &storage, const std::string &key, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
 
-    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+private:
+    const std::string _key;
 };
 
 } // namespace Execute
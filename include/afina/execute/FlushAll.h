@@ -0,0 +1,41 @@
+#ifndef AFINA_EXECUTE_FLUSH_ALL_H
+#define AFINA_EXECUTE_FLUSH_ALL_H
+
+#include <cstdint>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Invalidate all items
+ * Removes everything from the storage. Storage doesn't expire items, so it
+ * can't postpone flush to the time client asks for, such a request is rejected
+ *
+ * Command must write result to the output, which could be:
+ * - "OK" to indicate success
+ * - "CLIENT_ERROR <reason>" if delay isn't zero
+ */
+class FlushAll : public Command {
+public:
+    FlushAll(int32_t delay) : _delay(delay) {}
+    ~FlushAll() {}
+
+    inline int32_t delay() const { return _delay; }
+
+    /**
+     * Executes the command with the given fields, without building the object
+     */
+    static void Run(Storage &storage, int32_t delay, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
+
+private:
+    const int32_t _delay;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_FLUSH_ALL_H
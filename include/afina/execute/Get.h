@@ -34,15 +34,26 @@ namespace Execute {
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    Get(const std::vector<std::string> &keys) : Get(keys, false) {}
     ~Get() {}
 
     inline const std::vector<std::string> &keys() const { return _keys; }
 
-    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    /**
+     * Executes the command with the given fields, without building the object
+     */
+    static void Run(Storage &storage, const std::string *keys, std::size_t count, bool versions, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
+
+protected:
+    Get(const std::vector<std::string> &keys, bool versions) : _keys(keys), _versions(versions) {}
 
 private:
     std::vector<std::string> _keys;
+
+    // Whether items are followed by their versions
+    bool _versions;
 };
 
 } // namespace Execute
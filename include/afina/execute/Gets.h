@@ -0,0 +1,28 @@
+#ifndef AFINA_EXECUTE_GETS_H
+#define AFINA_EXECUTE_GETS_H
+
+#include <string>
+#include <vector>
+
+#include "Get.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Retrive value and its version for the key
+ * Same as Get, but each item is followed by its version, which could be
+ * passed to Cas later:
+ * VALUE <key> <flags> <bytes> <cas unique>\r\n
+ * <data>\r\n
+ */
+class Gets : public Get {
+public:
+    Gets(const std::vector<std::string> &keys) : Get(keys, true) {}
+    ~Gets() {}
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_GETS_H
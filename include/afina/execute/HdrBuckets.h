@@ -0,0 +1,59 @@
+#ifndef AFINA_EXECUTE_HDR_BUCKETS_H
+#define AFINA_EXECUTE_HDR_BUCKETS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Bucket layout of HDR-style histograms
+ * Values below 2 * SubBuckets get a bucket each, every power of two range above is split into SubBuckets
+ * linear buckets, so any value is kept with error under 1 / SubBuckets. Values of MaxBits bits and more are
+ * counted as the largest one
+ */
+template <unsigned SubBits, unsigned MaxBits = 64> struct HdrBuckets {
+    static_assert(SubBits < MaxBits && MaxBits <= 64, "Sub buckets must fit into the value range");
+
+    static constexpr std::size_t SubBuckets = std::size_t(1) << SubBits;
+
+    // Ranges [2^k, 2^(k+1)) for k in [SubBits + 1, MaxBits) take a row each, plus two rows of exact values
+    static constexpr std::size_t Buckets = (MaxBits - SubBits + 1) * SubBuckets;
+
+    // Largest value counted as is
+    static constexpr uint64_t MaxValue = MaxBits < 64 ? (uint64_t(1) << (MaxBits % 64)) - 1 : ~uint64_t(0);
+
+    /**
+     * Bucket the value goes to
+     */
+    static std::size_t Index(uint64_t value) {
+        value = std::min(value, MaxValue);
+        if (value < 2 * SubBuckets) {
+            return value;
+        }
+        unsigned shift = 63 - __builtin_clzll(value) - SubBits;
+        return (shift + 1) * SubBuckets + (value >> shift) - SubBuckets;
+    }
+
+    /**
+     * Largest value which goes to the bucket
+     */
+    static uint64_t Highest(std::size_t index) {
+        if (index < 2 * SubBuckets) {
+            return index;
+        }
+        unsigned shift = index / SubBuckets - 1;
+        return (uint64_t((index % SubBuckets) + SubBuckets + 1) << shift) - 1;
+    }
+};
+
+template <unsigned SubBits, unsigned MaxBits> constexpr std::size_t HdrBuckets<SubBits, MaxBits>::SubBuckets;
+template <unsigned SubBits, unsigned MaxBits> constexpr std::size_t HdrBuckets<SubBits, MaxBits>::Buckets;
+template <unsigned SubBits, unsigned MaxBits> constexpr uint64_t HdrBuckets<SubBits, MaxBits>::MaxValue;
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_HDR_BUCKETS_H
@@ -0,0 +1,56 @@
+#ifndef AFINA_EXECUTE_INCR_H
+#define AFINA_EXECUTE_INCR_H
+
+#include <cstdint>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Increment value for the key
+ * Treats value as decimal representation of 64-bit unsigned integer and adds
+ * given delta to it, wrapping around on overflow. Value is changed atomically
+ * with a single storage call. If key wasn't found then command does nothing,
+ * unless it was asked to start counter from the initial value
+ *
+ * Command must write result to the output, which could be:
+ * - new value of the item
+ * - "NOT_FOUND" to indicate that the item with this key was not found
+ * - "CLIENT_ERROR cannot increment or decrement non-numeric value" if current
+ * value isn't a number
+ */
+class Incr : public Command {
+public:
+    Incr(const std::string &key, uint64_t delta) : Incr(key, delta, 0, false, false) {}
+    Incr(const std::string &key, uint64_t delta, uint64_t initial) : Incr(key, delta, initial, true, false) {}
+    ~Incr() {}
+
+    inline const std::string &key() const { return _key; }
+    inline uint64_t delta() const { return _delta; }
+
+    /**
+     * Executes the command with the given fields, without building the object
+     */
+    static void Run(Storage &storage, const std::string &key, uint64_t delta, uint64_t initial, bool create,
+                    bool decrement, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
+
+protected:
+    Incr(const std::string &key, uint64_t delta, uint64_t initial, bool create, bool decrement)
+        : _key(key), _delta(delta), _initial(initial), _create(create), _decrement(decrement) {}
+
+    const std::string _key;
+    const uint64_t _delta;
+    const uint64_t _initial;
+    const bool _create;
+    const bool _decrement;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_INCR_H
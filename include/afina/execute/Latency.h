@@ -0,0 +1,115 @@
+#ifndef AFINA_EXECUTE_LATENCY_H
+#define AFINA_EXECUTE_LATENCY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "HdrBuckets.h"
+#include "Request.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Where commands spend time
+ * Latency histograms of every command kind for each stage of its processing: parsing of the command line,
+ * execution against storage and writing the response to the socket. Responses to all commands of a read are
+ * written at once, so each of them is accounted the time of the whole write.
+ *
+ * Each thread records into its own set of histograms, so recording is a few relaxed atomic stores without
+ * any contention. Reader sums sets of all threads up, sets of finished threads are folded into a common one.
+ * Only every Sampling()-th command gets measured. Sampling 0 turns measurement off, processing then costs
+ * a single relaxed load per input
+ */
+class Latency {
+public:
+    enum class Stage : uint8_t { Parse, Storage, Write };
+
+    static constexpr std::size_t Stages = 3;
+    static constexpr std::size_t Kinds = std::size_t(Request::Kind::Stats) + 1;
+
+    /**
+     * # HDR-style histogram of nanoseconds
+     * Any value up to a minute is kept with error under 1 / SubBuckets by a few hundred counters, see
+     * HdrBuckets. Larger values are counted as the largest one.
+     *
+     * Single thread records, any number of threads could read at the same time
+     */
+    class Histogram {
+    public:
+        typedef HdrBuckets<4, 36> Layout;
+        static constexpr std::size_t SubBuckets = Layout::SubBuckets;
+        static constexpr std::size_t Buckets = Layout::Buckets;
+
+        Histogram();
+
+        /**
+         * Accounts value, must be called by a single thread
+         */
+        void Record(uint64_t value);
+
+        /**
+         * Adds counters of the other histogram to this one, which mustn't be recorded into meanwhile
+         */
+        void Add(const Histogram &other);
+
+        inline uint64_t Count() const { return _count.load(std::memory_order_relaxed); }
+        inline uint64_t Sum() const { return _sum.load(std::memory_order_relaxed); }
+        inline uint64_t Max() const { return _max.load(std::memory_order_relaxed); }
+
+        /**
+         * Smallest value which isn't exceeded by the given share of the recorded ones, p is in [0, 1]
+         */
+        uint64_t Percentile(double p) const;
+
+    private:
+        Histogram(const Histogram &) = delete;
+        Histogram &operator=(const Histogram &) = delete;
+
+        std::atomic<uint64_t> _counts[Buckets];
+        std::atomic<uint64_t> _count;
+        std::atomic<uint64_t> _sum;
+        std::atomic<uint64_t> _max;
+    };
+
+    /**
+     * Histograms of all command kinds and stages
+     */
+    struct Set {
+        Histogram histograms[Kinds][Stages];
+
+        inline Histogram &Of(Request::Kind kind, Stage stage) {
+            return histograms[std::size_t(kind)][std::size_t(stage)];
+        }
+    };
+
+    /**
+     * Every which command is measured, 0 if none
+     */
+    static inline uint32_t Sampling() { return _sampling.load(std::memory_order_relaxed); }
+    static void SetSampling(uint32_t every);
+
+    /**
+     * Accounts time command of the given kind spent at the stage into the set of the calling thread
+     */
+    static void Record(Request::Kind kind, Stage stage, uint64_t nanoseconds);
+
+    /**
+     * Adds counters of all threads to the given set
+     */
+    static void Collect(Set &result);
+
+    /**
+     * Name of the stage to report it by
+     */
+    static const char *Name(Stage stage);
+
+private:
+    static std::atomic<uint32_t> _sampling;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_LATENCY_H
@@ -0,0 +1,92 @@
+#ifndef AFINA_EXECUTE_REQUEST_H
+#define AFINA_EXECUTE_REQUEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Response.h"
+
+namespace Afina {
+
+class Storage;
+
+namespace Execute {
+
+/**
+ * # Command kept inline
+ * Same commands as Command subclasses, but as a plain record which parser fills in and which is executed
+ * through a switch over its kind. Connection keeps requests and reuses them for the next commands, keys keep
+ * their memory, so no command object is allocated per request.
+ *
+ * Fields which don't make sense for the kind are zero
+ */
+class Request {
+public:
+    enum class Kind : uint8_t {
+        None,
+        Set,
+        Add,
+        Replace,
+        Cas,
+        Append,
+        Prepend,
+        Get,
+        Gets,
+        Delete,
+        Incr,
+        Decr,
+        Touch,
+        FlushAll,
+        Stats
+    };
+
+    Request() : _keys_count(0) { Reset(); }
+    ~Request() {}
+
+    /**
+     * Name of the command as text protocol knows it, empty string for None
+     */
+    static const char *Name(Kind kind);
+
+    /**
+     * Forgets the command, memory of the keys is kept
+     */
+    void Reset();
+
+    /**
+     * Adds key to the request, retrieval commands could have several of them
+     */
+    void AddKey(const char *data, std::size_t size);
+
+    inline const std::string &Key() const { return _keys[0]; }
+    inline const std::string *Keys() const { return _keys.data(); }
+    inline std::size_t KeysCount() const { return _keys_count; }
+
+    /**
+     * Runs the command, see Command::Execute. Request of kind None does nothing. Storage commands take
+     * memory of the data block over, so args is unspecified afterwards
+     */
+    void Execute(Storage &storage, std::string &args, Response &out) const;
+
+    Kind kind;
+    uint32_t flags;
+    int32_t expire;
+    uint64_t delta;
+    uint64_t initial;
+    uint64_t version;
+
+    // Whether incr/decr creates the item with the initial value
+    bool create;
+
+private:
+    // First _keys_count keys belong to the request, rest are kept to reuse their memory
+    std::vector<std::string> _keys;
+    std::size_t _keys_count;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_REQUEST_H
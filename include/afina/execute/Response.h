@@ -0,0 +1,177 @@
+#ifndef AFINA_EXECUTE_RESPONSE_H
+#define AFINA_EXECUTE_RESPONSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Result of the command execution
+ * Commands write their results here instead of building strings. Short text parts are appended into the
+ * internal buffer, which keeps its capacity between commands once response is cleared. Values taken out of
+ * storage are attached as is, so they are not copied until response is written out.
+ *
+ * Response is a sequence of segments, each of which is either a part of the internal buffer or the attached
+ * value. Responses of the whole batch are collected into one by Append, network layer writes its segments
+ * out with a gather call and copies only what the socket doesn't accept right away.
+ *
+ * Besides the text, command reports its outcome in a structured form: status, version of the item, counter
+ * value and the item found. Text protocol sends the text, binary one encodes its response from the outcome
+ */
+class Response {
+public:
+    /**
+     * What command has done
+     */
+    enum class Status : uint8_t {
+        // Command doesn't report outcome
+        None,
+        Stored,
+        NotStored,
+        Exists,
+        NotFound,
+        Deleted,
+        Touched,
+        // Item is found, see Item
+        Found,
+        // Counter is changed or created, see Counter
+        Counted,
+        NonNumeric,
+        Ok,
+        // Command is valid, but server doesn't do what it asks for
+        Refused
+    };
+
+    /**
+     * Continuous chunk of the response bytes, valid until response is changed
+     */
+    struct Segment {
+        const char *data;
+        std::size_t size;
+    };
+
+    Response() : _size(0), _status(Status::None), _version(0), _counter(0), _item(Part::Buffer) {}
+    ~Response() {}
+
+    /**
+     * Makes room for the given number of bytes of text parts
+     */
+    inline void Reserve(std::size_t size) { _buffer.reserve(size); }
+
+    /**
+     * Appends copy of the given bytes
+     */
+    Response &Append(const char *data, std::size_t size);
+    inline Response &Append(const char *str) { return Append(str, std::strlen(str)); }
+    inline Response &Append(const std::string &str) { return Append(str.data(), str.size()); }
+
+    /**
+     * Appends decimal representation of the number
+     */
+    Response &Append(uint64_t value);
+
+    /**
+     * Appends the whole value, response takes ownership of its memory instead of copying it
+     */
+    inline Response &Attach(std::string &&value) { return Attach(std::move(value), value.size()); }
+
+    /**
+     * Appends first size bytes of the value, response takes ownership of its memory instead of copying it
+     */
+    Response &Attach(std::string &&value, std::size_t size);
+
+    /**
+     * Attaches value of the item command has found, the first such value is reported by Item
+     */
+    Response &AttachItem(std::string &&value);
+
+    /**
+     * Appends content of the other response, its attached values are moved over instead of copied. Other
+     * response is left empty
+     */
+    Response &Append(Response &&other);
+
+    inline void SetStatus(Status status) { _status = status; }
+    inline Status GetStatus() const { return _status; }
+
+    /**
+     * Version of the item command has stored or found first, zero if there is no such item. Text protocol
+     * reports it for gets only, binary one sends it back as CAS of the response
+     */
+    inline void SetVersion(uint64_t version) { _version = version; }
+    inline uint64_t Version() const { return _version; }
+
+    /**
+     * Value of the counter incr/decr has left
+     */
+    inline void SetCounter(uint64_t value) { _counter = value; }
+    inline uint64_t Counter() const { return _counter; }
+
+    /**
+     * Value of the first item attached by AttachItem, nullptr if there is none. Value could be moved out,
+     * response must be cleared then
+     */
+    inline std::string *Item() { return (_item == Part::Buffer) ? nullptr : &_values[_item]; }
+
+    /**
+     * Drops all the content, allocated memory is kept for the next response
+     */
+    void Clear();
+
+    /**
+     * Total number of bytes in the response
+     */
+    inline std::size_t Size() const { return _size; }
+    inline bool Empty() const { return _size == 0; }
+
+    /**
+     * Fills at most count segments with the response bytes, starting at the given offset. Returns number of
+     * segments filled, zero once offset reaches the end
+     */
+    std::size_t Gather(std::size_t offset, Segment *segments, std::size_t count) const;
+
+    /**
+     * Appends all bytes of the response to the given string
+     */
+    void CopyTo(std::string &out) const;
+
+    /**
+     * Returns copy of the response as a single string
+     */
+    std::string Str() const;
+
+private:
+    // Part of the response, either range of _buffer or the whole _values[value]
+    struct Part {
+        static const std::size_t Buffer = std::size_t(-1);
+
+        std::size_t value;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    Segment _segment(const Part &part) const;
+
+    std::size_t _size;
+    Status _status;
+    uint64_t _version;
+    uint64_t _counter;
+
+    // Index of the item value in _values, Part::Buffer if there is none
+    std::size_t _item;
+
+    std::string _buffer;
+    std::vector<std::string> _values;
+    std::vector<Part> _parts;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_RESPONSE_H
@@ -8,11 +8,29 @@
 namespace Afina {
 namespace Execute {
 
+/**
+ * # Server statistics
+ * Reports statistics of the given group as "STAT <name> <value>" lines followed by "END":
+ * - no group: general statistics, there are none yet
+ * - "commands": how many commands of each kind were measured and their mean time at every stage, in
+ *   nanoseconds, see Latency
+ * - "latency": percentiles of the time commands of each kind spent at every stage, in nanoseconds
+ *
+ * Unknown group is reported as "CLIENT_ERROR"
+ */
 class Stats : public Command {
 public:
-    Stats() {}
+    Stats(const std::string &group = "") : _group(group) {}
     ~Stats() {}
-    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    /**
+     * Executes the command with the given fields, without building the object
+     */
+    static void Run(Storage &storage, const std::string &group, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
+
+private:
+    std::string _group;
 };
 
 } // namespace Execute
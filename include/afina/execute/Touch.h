@@ -0,0 +1,45 @@
+#ifndef AFINA_EXECUTE_TOUCH_H
+#define AFINA_EXECUTE_TOUCH_H
+
+#include <cstdint>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Update expiration time of the key
+ * Storage doesn't expire items, they leave it only when evicted as least
+ * recently used. So touch just marks the item as used, the same as any
+ * other command does
+ *
+ * Command must write result to the output, which could be:
+ * - "TOUCHED" to indicate success
+ * - "NOT_FOUND" to indicate that the item with this key was not found
+ */
+class Touch : public Command {
+public:
+    Touch(const std::string &key, int32_t expire) : _key(key), _expire(expire) {}
+    ~Touch() {}
+
+    inline const std::string &key() const { return _key; }
+    inline int32_t expire() const { return _expire; }
+
+    /**
+     * Executes the command with the given fields, without building the object
+     */
+    static void Run(Storage &storage, const std::string &key, int32_t expire, Response &out);
+
+    void Execute(Storage &storage, const std::string &args, Response &out) override;
+
+private:
+    const std::string _key;
+    const int32_t _expire;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_TOUCH_H
@@ -100,6 +100,12 @@ public:
      * Name of append logger will writes to
      */
     std::vector<std::string> appenders;
+
+    /*
+     * Whether messages are written by the background thread, hot paths must not wait for appenders.
+     * Messages which don't fit in the queue are dropped
+     */
+    bool async = false;
 };
 
 /**
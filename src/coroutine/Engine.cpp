@@ -3,11 +3,154 @@
 #include <setjmp.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <cassert>
 #include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__ELF__)
+#define AFINA_COROUTINE_SEPARATE_STACK 1
+
+// Saves callee-saved registers together with SSE/x87 control words on the current stack, stores stack pointer
+// into *from and continues execution on the stack to. Stack of the coroutine which never run yet is prepared
+// by Engine::Spawn to look like it has been suspended here, so the final ret jumps into afina_coroutine_start
+extern "C" void afina_coroutine_switch(void **from, void *to);
+
+// First code executed on a fresh coroutine stack: calls r12(r13, rbx), i.e Engine::Trampoline(engine, ctx)
+extern "C" void afina_coroutine_start();
+
+asm(".text\n"
+    ".globl afina_coroutine_switch\n"
+    ".hidden afina_coroutine_switch\n"
+    ".type afina_coroutine_switch,@function\n"
+    "afina_coroutine_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size afina_coroutine_switch,.-afina_coroutine_switch\n"
+    ".globl afina_coroutine_start\n"
+    ".hidden afina_coroutine_start\n"
+    ".type afina_coroutine_start,@function\n"
+    "afina_coroutine_start:\n"
+    "    movq %r13, %rdi\n"
+    "    movq %rbx, %rsi\n"
+    "    callq *%r12\n"
+    "    ud2\n"
+    ".size afina_coroutine_start,.-afina_coroutine_start\n");
+#else
+#define AFINA_COROUTINE_SEPARATE_STACK 0
+#endif
 
 namespace Afina {
 namespace Coroutine {
 
+constexpr std::size_t Engine::DefaultStackSize;
+constexpr std::size_t Engine::DefaultMaxCached;
+constexpr unsigned Engine::DefaultQuantum;
+
+Engine::Engine(std::function<void()> _idle_func, StackMode mode, std::size_t stack_size, std::size_t max_cached)
+    : StackBottom(0), cur_routine(nullptr), alive(nullptr), alive_tail(nullptr), idle_ctx(nullptr),
+      blocked(nullptr), idle_func(_idle_func), _mode(mode), _stack_size(stack_size), _zombie(nullptr),
+      _switches(0), _runnable(0), _max_runnable(0), _blocked(0), _pool(max_cached), _free_contexts(nullptr), _free_contexts_count(0), _max_cached(max_cached) {
+    if (_mode == StackMode::Separate && !SeparateStackSupported()) {
+        throw std::runtime_error("Separate coroutine stacks are not supported on this platform");
+    }
+}
+
+Engine::~Engine() {
+    while (_free_contexts != nullptr) {
+        context *next = _free_contexts->next;
+        delete _free_contexts;
+        _free_contexts = next;
+    }
+}
+
+void Engine::Prewarm(std::size_t coroutines) {
+    coroutines = std::min(coroutines, _max_cached);
+
+    std::vector<context *> prepared;
+    prepared.reserve(coroutines);
+    while (prepared.size() < coroutines) {
+        context *ctx = NewContext();
+        if (_mode == StackMode::Separate) {
+            ctx->StackMemorySize = _stack_size;
+            ctx->StackMemory = _pool.AcquireStack(ctx->StackMemorySize);
+        }
+        prepared.push_back(ctx);
+    }
+
+    for (context *ctx : prepared) {
+        DeleteContext(ctx);
+    }
+}
+
+Engine::context *Engine::NewContext() {
+    if (_free_contexts == nullptr) {
+        return new context();
+    }
+
+    context *ctx = _free_contexts;
+    _free_contexts = ctx->next;
+    _free_contexts_count--;
+
+    ctx->next = nullptr;
+    return ctx;
+}
+
+void Engine::DeleteContext(context *ctx) {
+    char *buffer = std::get<0>(ctx->Stack);
+    if (buffer != nullptr) {
+        _pool.ReleaseBuffer(buffer, std::get<1>(ctx->Stack));
+    }
+    if (ctx->StackMemory != nullptr) {
+        _pool.ReleaseStack(ctx->StackMemory, ctx->StackMemorySize);
+    }
+
+    if (_free_contexts_count >= _max_cached) {
+        delete ctx;
+        return;
+    }
+
+    // Bring context to the initial state, but keep it allocated
+    ctx->Low = ctx->Hight = nullptr;
+    ctx->Stack = std::make_tuple(nullptr, 0);
+    ctx->Sp = nullptr;
+    ctx->StackMemory = nullptr;
+    ctx->StackMemorySize = 0;
+    ctx->Entry = nullptr;
+    ctx->prev = nullptr;
+    ctx->blocked = false;
+    ctx->Quantum = 0;
+    ctx->HasTimer = false;
+    ctx->TimedOut = false;
+
+    ctx->next = _free_contexts;
+    _free_contexts = ctx;
+    _free_contexts_count++;
+}
+
+bool Engine::SeparateStackSupported() { return AFINA_COROUTINE_SEPARATE_STACK != 0; }
+
 void Engine::Store(context &ctx) {
 	char StackEndsHere;
 	if (&StackEndsHere > this->StackBottom) {
@@ -17,13 +160,14 @@ void Engine::Store(context &ctx) {
 		ctx.Low = &StackEndsHere;
 		ctx.Hight = this->StackBottom;
 	}
-	uint32_t stack_size = ctx.Hight - ctx.Low;
+	std::size_t stack_size = ctx.Hight - ctx.Low;
 	if ((stack_size > std::get<1>(ctx.Stack)) || (stack_size < std::get<1>(ctx.Stack) / 2)) {
 		if (std::get<0>(ctx.Stack) != nullptr) {
-			delete[] std::get<0>(ctx.Stack);
+			_pool.ReleaseBuffer(std::get<0>(ctx.Stack), std::get<1>(ctx.Stack));
 		}
-		char *newStack = new char[stack_size];
-		ctx.Stack = std::make_tuple(newStack, stack_size);
+		std::size_t capacity = stack_size;
+		char *newStack = _pool.AcquireBuffer(capacity);
+		ctx.Stack = std::make_tuple(newStack, capacity);
 	}
 	std::memcpy(std::get<0>(ctx.Stack), ctx.Low, stack_size);
 }
@@ -38,6 +182,18 @@ void Engine::Restore(context &ctx) {
 }
 
 void Engine::Enter(context &ctx) {
+#if AFINA_COROUTINE_SEPARATE_STACK
+	if (_mode == StackMode::Separate) {
+		context *from = cur_routine;
+		cur_routine = &ctx;
+		_switches++;
+		afina_coroutine_switch(&from->Sp, ctx.Sp);
+
+		// Got control back, someone might have finished right before that
+		Collect();
+		return;
+	}
+#endif
 	if ((cur_routine != nullptr) && (cur_routine != idle_ctx)) {
 		if (setjmp(cur_routine->Environment) > 0) {
 			return;
@@ -45,29 +201,30 @@ void Engine::Enter(context &ctx) {
 		Store(*cur_routine); 
 	}
 	cur_routine = &ctx;
+	_switches++;
 	Restore(ctx);
 }
 
 void Engine::yield() {
-	context *next_ctx = this->alive;
-	if (next_ctx != nullptr) {
-		if (next_ctx == cur_routine) {
-			next_ctx = next_ctx->next;
-			if (next_ctx != nullptr) {
-				Enter(*next_ctx);
-			}
-		} else {
-			Enter(*next_ctx);
-		}
-	}
+    context *cur = cur_routine;
+    if ((cur != nullptr) && (cur != idle_ctx) && !cur->blocked) {
+        if (alive == cur && cur->next == nullptr) {
+            // Nobody else to run
+            return;
+        }
 
-	if (cur_routine != nullptr && !cur_routine->blocked) {
-		return;
-	}
-	if (cur_routine != idle_ctx) {
-		Enter(*idle_ctx);
-	}
-	Enter(*idle_ctx);
+        // Round robin: current routine lets everyone ready to run go first, that also starts its new quantum
+        Dequeue(cur);
+        Enqueue(cur);
+        cur->Quantum = DefaultQuantum;
+    }
+
+    if (alive != nullptr) {
+        Enter(*alive);
+    } else if ((cur != idle_ctx) && ((cur == nullptr) || cur->blocked)) {
+        // Nobody could run, let idle context decide what to do
+        Enter(*idle_ctx);
+    }
 }
 
 void Engine::sched(void *routine_) {
@@ -80,51 +237,272 @@ void Engine::sched(void *routine_) {
 	}
 }
 
-void Engine::MoveCoroutine(context *&fromlist, context *&tolist, context *routine) {
-    if (fromlist == tolist) {
-        return;
+void Engine::Enqueue(context *routine, bool front) {
+    if (front) {
+        routine->prev = nullptr;
+        routine->next = alive;
+        if (alive != nullptr) {
+            alive->prev = routine;
+        } else {
+            alive_tail = routine;
+        }
+        alive = routine;
+    } else {
+        routine->prev = alive_tail;
+        routine->next = nullptr;
+        if (alive_tail != nullptr) {
+            alive_tail->next = routine;
+        } else {
+            alive = routine;
+        }
+        alive_tail = routine;
+    }
+
+    _runnable++;
+    _max_runnable = std::max(_max_runnable, _runnable);
+}
+
+void Engine::Dequeue(context *routine) {
+    if (routine->prev != nullptr) {
+        routine->prev->next = routine->next;
+    } else {
+        alive = routine->next;
     }
     if (routine->next != nullptr) {
         routine->next->prev = routine->prev;
+    } else {
+        alive_tail = routine->prev;
+    }
+    routine->prev = routine->next = nullptr;
+    _runnable--;
+}
+
+void Engine::PushBlocked(context *routine) {
+    routine->prev = nullptr;
+    routine->next = blocked;
+    if (blocked != nullptr) {
+        blocked->prev = routine;
     }
+    blocked = routine;
+    _blocked++;
+}
+
+void Engine::RemoveBlocked(context *routine) {
     if (routine->prev != nullptr) {
         routine->prev->next = routine->next;
+    } else {
+        blocked = routine->next;
     }
-    if (routine == fromlist) {
-        fromlist = fromlist->next;
-    }
-    routine->next = tolist;
-    tolist = routine;
     if (routine->next != nullptr) {
-        routine->next->prev = routine;
+        routine->next->prev = routine->prev;
     }
+    routine->prev = routine->next = nullptr;
+    _blocked--;
 }
 
 void Engine::Block() {
     if (!(cur_routine->blocked)) {
         cur_routine->blocked = true;
-        MoveCoroutine(alive, blocked, cur_routine);
+        Dequeue(cur_routine);
+        PushBlocked(cur_routine);
     }
     yield();
 }
 
 void Engine::Wake(context *ctx) {
     if (ctx->blocked) {
+        if (ctx->HasTimer) {
+            _timers.erase(ctx->Timer);
+            ctx->HasTimer = false;
+        }
         ctx->blocked = false;
-        MoveCoroutine(blocked, alive, ctx);
+        ctx->Quantum = DefaultQuantum;
+        RemoveBlocked(ctx);
+        Enqueue(ctx);
     }
 }
 
+void Engine::Handoff(context *ctx) {
+    context *cur = cur_routine;
+    if (!ctx->blocked || (cur == nullptr) || (cur == idle_ctx) || (cur->Quantum == 0)) {
+        Wake(ctx);
+        return;
+    }
+
+    Wake(ctx);
+    Dequeue(ctx);
+    Enqueue(ctx, true);
+    ctx->Quantum = cur->Quantum - 1;
+}
+
 void Engine::WakeAll(void) {
     for (context *ctx = blocked; ctx != nullptr; ctx = blocked) {
         Wake(ctx);
     }
 }
 
+bool Engine::BlockUntil(Clock::time_point deadline) {
+    context *ctx = cur_routine;
+    ctx->TimedOut = false;
+    ctx->Timer = _timers.emplace(deadline, ctx);
+    ctx->HasTimer = true;
+
+    Block();
+    return !ctx->TimedOut;
+}
+
+void Engine::WakeExpired() {
+    if (_timers.empty()) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    while (!_timers.empty() && _timers.begin()->first <= now) {
+        context *ctx = _timers.begin()->second;
+        _timers.erase(_timers.begin());
+        ctx->HasTimer = false;
+        ctx->TimedOut = true;
+        Wake(ctx);
+    }
+}
+
+int Engine::NextTimeout() const {
+    if (_timers.empty()) {
+        return -1;
+    }
+
+    Clock::duration left = _timers.begin()->first - Clock::now();
+    if (left <= Clock::duration::zero()) {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(left + std::chrono::milliseconds(1) -
+                                                                 Clock::duration(1))
+        .count();
+}
+
 bool Engine::all_blocked() const { return !alive && blocked; }
 
+Engine::Stats Engine::GetStats() const {
+    Stats result;
+    result.switches = _switches;
+    result.runnable = _runnable;
+    result.max_runnable = _max_runnable;
+    result.blocked = _blocked;
+    return result;
+}
+
 Engine::context *Engine::get_cur_routine() const { return cur_routine; }
 
+void *Engine::Spawn(std::function<void()> &&func) {
+#if AFINA_COROUTINE_SEPARATE_STACK
+    std::size_t size = _stack_size;
+    char *memory = _pool.AcquireStack(size);
+
+    context *pc = NewContext();
+    pc->StackMemory = memory;
+    pc->StackMemorySize = size;
+    pc->Entry = std::move(func);
+
+    // Initial frame, the same afina_coroutine_switch leaves on suspend. Return address is placed so that
+    // afina_coroutine_start gets stack aligned to 16 bytes as ABI requires before call
+    uint64_t *sp = reinterpret_cast<uint64_t *>(pc->StackMemory + size);
+    *--sp = 0;
+    *--sp = 0;
+    *--sp = reinterpret_cast<uint64_t>(&afina_coroutine_start);
+    *--sp = 0;                                                  // rbp
+    *--sp = reinterpret_cast<uint64_t>(pc);                     // rbx
+    *--sp = reinterpret_cast<uint64_t>(&Engine::Trampoline);    // r12
+    *--sp = reinterpret_cast<uint64_t>(this);                   // r13
+    *--sp = 0;                                                  // r14
+    *--sp = 0;                                                  // r15
+    *--sp = (static_cast<uint64_t>(0x037F) << 32) | 0x1F80;     // x87 control word, MXCSR: defaults
+    pc->Sp = sp;
+
+    // Routine is ready to run
+    pc->blocked = false;
+    pc->Quantum = DefaultQuantum;
+    Enqueue(pc);
+
+    return pc;
+#else
+    throw std::runtime_error("Separate coroutine stacks are not supported on this platform");
+#endif
+}
+
+void Engine::Trampoline(Engine *engine, context *ctx) {
+#if AFINA_COROUTINE_SEPARATE_STACK
+    // Coroutine starts here instead of returning from Enter, so do its part of work
+    engine->Collect();
+
+    ctx->Entry();
+    ctx->Entry = nullptr;
+
+    // Routine has completed its execution, unlink it. Stack can't be released right now as we are still
+    // running on it, so it is left for whoever gets control next
+    engine->Dequeue(ctx);
+    engine->_zombie = ctx;
+
+    // Idle context selects who is going to run next, control never returns here
+    engine->cur_routine = engine->idle_ctx;
+    engine->_switches++;
+    afina_coroutine_switch(&ctx->Sp, engine->idle_ctx->Sp);
+#endif
+}
+
+void Engine::Collect() {
+    if (_zombie == nullptr) {
+        return;
+    }
+
+    DeleteContext(_zombie);
+    _zombie = nullptr;
+}
+
+void Engine::Loop(void *pc) {
+    if (pc != nullptr) {
+        sched(pc);
+    }
+
+    for (;;) {
+        WakeExpired();
+        if (alive != nullptr) {
+            yield();
+            continue;
+        }
+        if (blocked == nullptr) {
+            break;
+        }
+
+        // Everyone is blocked, idle function is expected to wake someone up. If it doesn't, only timers
+        // could do that
+        std::size_t switches = _switches;
+        idle_func();
+        if (alive == nullptr && switches == _switches) {
+            if (_timers.empty()) {
+                break;
+            }
+            std::this_thread::sleep_until(_timers.begin()->first);
+        }
+    }
+
+    // Nobody is going to wake coroutines still blocked, see start(). Their stacks can't be unwound, so
+    // objects living there would leak. Release builds at least give the memory of contexts back
+    assert(blocked == nullptr && "coroutines left blocked once engine has run out of work");
+    _timers.clear();
+    while (blocked != nullptr) {
+        context *ctx = blocked;
+        RemoveBlocked(ctx);
+        _zombie = ctx;
+        Collect();
+    }
+
+    // Shutdown runtime
+    DeleteContext(idle_ctx);
+    idle_ctx = nullptr;
+    cur_routine = nullptr;
+    this->StackBottom = 0;
+}
+
 
 } // namespace Coroutine
 } // namespace Afina
@@ -0,0 +1,118 @@
+#include <afina/coroutine/StackPool.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Coroutine {
+
+constexpr std::size_t StackPool::MinBufferSize;
+constexpr std::size_t StackPool::MaxBufferSize;
+
+// See StackPool.h
+StackPool::StackPool(std::size_t max_cached) : _buffers(_class(MaxBufferSize) + 1), _max_cached(max_cached) {}
+
+// See StackPool.h
+StackPool::~StackPool() {
+    for (auto &buffers : _buffers) {
+        for (char *buffer : buffers) {
+            delete[] buffer;
+        }
+    }
+    for (auto &stack : _stacks) {
+        munmap(stack.first, stack.second);
+    }
+}
+
+// See StackPool.h
+char *StackPool::AcquireBuffer(std::size_t &size) {
+    if (size > MaxBufferSize) {
+        return new char[size];
+    }
+
+    std::size_t cls = _class(size);
+    size = MinBufferSize << cls;
+    if (!_buffers[cls].empty()) {
+        char *result = _buffers[cls].back();
+        _buffers[cls].pop_back();
+        return result;
+    }
+    return new char[size];
+}
+
+// See StackPool.h
+void StackPool::ReleaseBuffer(char *buffer, std::size_t size) {
+    if (size > MaxBufferSize) {
+        delete[] buffer;
+        return;
+    }
+
+    auto &buffers = _buffers[_class(size)];
+    if (buffers.size() >= _max_cached) {
+        delete[] buffer;
+        return;
+    }
+    buffers.push_back(buffer);
+}
+
+// See StackPool.h
+char *StackPool::AcquireStack(std::size_t &size) {
+    std::size_t page = sysconf(_SC_PAGESIZE);
+    size = ((size + page - 1) / page + 1) * page;
+
+    for (auto it = _stacks.rbegin(); it != _stacks.rend(); ++it) {
+        if (it->second == size) {
+            char *result = it->first;
+            _stacks.erase(std::next(it).base());
+            return result;
+        }
+    }
+
+    // Stack grows down, so the lowest page stays inaccessible and turns overflow into SIGSEGV instead of
+    // silent corruption of a neighbour memory
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("Failed to allocate coroutine stack: " + std::string(strerror(errno)));
+    }
+    if (mprotect(memory, page, PROT_NONE) != 0) {
+        munmap(memory, size);
+        throw std::runtime_error("Failed to protect coroutine stack: " + std::string(strerror(errno)));
+    }
+    return static_cast<char *>(memory);
+}
+
+// See StackPool.h
+void StackPool::ReleaseStack(char *stack, std::size_t size) {
+    if (_stacks.size() >= _max_cached) {
+        munmap(stack, size);
+        return;
+    }
+    _stacks.emplace_back(stack, size);
+}
+
+// See StackPool.h
+std::size_t StackPool::Cached() const {
+    std::size_t result = _stacks.size();
+    for (auto &buffers : _buffers) {
+        result += buffers.size();
+    }
+    return result;
+}
+
+// See StackPool.h
+std::size_t StackPool::_class(std::size_t size) {
+    std::size_t cls = 0;
+    while ((MinBufferSize << cls) < size) {
+        cls++;
+    }
+    return cls;
+}
+
+} // namespace Coroutine
+} // namespace Afina
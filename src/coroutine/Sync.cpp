@@ -0,0 +1,95 @@
+#include <afina/coroutine/Sync.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace Afina {
+namespace Coroutine {
+
+// See Sync.h
+void WaitQueue::Wait() {
+    Engine::context *self = _engine.get_cur_routine();
+    _waiters.push_back(self);
+    _engine.Block();
+
+    // Woken by somebody else, don't leave dangling pointer behind
+    auto it = std::find(_waiters.begin(), _waiters.end(), self);
+    if (it != _waiters.end()) {
+        _waiters.erase(it);
+    }
+}
+
+// See Sync.h
+bool WaitQueue::NotifyOne() {
+    if (_waiters.empty()) {
+        return false;
+    }
+
+    Engine::context *ctx = _waiters.front();
+    _waiters.pop_front();
+    _engine.Handoff(ctx);
+    return true;
+}
+
+// See Sync.h
+void WaitQueue::NotifyAll() {
+    while (!_waiters.empty()) {
+        _engine.Wake(_waiters.front());
+        _waiters.pop_front();
+    }
+}
+
+// See Sync.h
+void Mutex::Lock() {
+    while (_locked) {
+        _waiters.Wait();
+    }
+    _locked = true;
+}
+
+// See Sync.h
+bool Mutex::TryLock() {
+    if (_locked) {
+        return false;
+    }
+    _locked = true;
+    return true;
+}
+
+// See Sync.h
+void Mutex::Unlock() {
+    assert(_locked);
+    _locked = false;
+    _waiters.NotifyOne();
+}
+
+// See Sync.h
+void Event::Set() {
+    _set = true;
+    _waiters.NotifyAll();
+}
+
+// See Sync.h
+void Event::Wait() {
+    while (!_set) {
+        _waiters.Wait();
+    }
+}
+
+// See Sync.h
+void WaitGroup::Done() {
+    assert(_counter > 0);
+    if (--_counter == 0) {
+        _waiters.NotifyAll();
+    }
+}
+
+// See Sync.h
+void WaitGroup::Wait() {
+    while (_counter > 0) {
+        _waiters.Wait();
+    }
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -1,16 +1,24 @@
 #include <afina/Storage.h>
 #include <afina/execute/Add.h>
 
-#include <iostream>
+#include <utility>
 
 namespace Afina {
 namespace Execute {
 
 // memcached protocol:  "add" means "store this data, but only if the server *doesn't* already
 // hold data for this key".
-void Add::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Add(" << _key << ")" << args << std::endl;
-    out = storage.PutIfAbsent(_key, args) ? "STORED" : "NOT_STORED";
+void Add::Run(Storage &storage, const std::string &key, std::string &&args, Response &out) {
+    uint64_t version;
+    bool stored = storage.PutIfAbsent(key, std::move(args), &version);
+    out.SetStatus(stored ? Response::Status::Stored : Response::Status::NotStored);
+    out.SetVersion(version);
+    out.Append(stored ? "STORED" : "NOT_STORED");
+}
+
+// See Add.h
+void Add::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _key, std::string(args), out);
 }
 
 } // namespace Execute
@@ -1,22 +1,24 @@
 #include <afina/Storage.h>
 #include <afina/execute/Append.h>
 
-#include <iostream>
+#include <utility>
 
 namespace Afina {
 namespace Execute {
 
 // memcached protocol: "append" means "add this data to an existing key after existing data".
-void Append::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Append(" << _key << ")" << args << std::endl;
-    std::string value;
-    if (!storage.Get(_key, value)) {
-        out.assign("NOT_STORED");
-        return;
-    }
-    value = value.substr(0, value.size() - 2);
-    storage.Put(_key, value + args);
-    out.assign("STORED");
+void Append::Run(Storage &storage, const std::string &key, std::string &&args, Response &out) {
+    // Both values end with \r\n, only the one of the new data must stay
+    uint64_t version;
+    bool stored = storage.Append(key, std::move(args), 2, &version);
+    out.SetStatus(stored ? Response::Status::Stored : Response::Status::NotStored);
+    out.SetVersion(version);
+    out.Append(stored ? "STORED" : "NOT_STORED");
+}
+
+// See Append.h
+void Append::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _key, std::string(args), out);
 }
 
 } // namespace Execute
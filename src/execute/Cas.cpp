@@ -0,0 +1,31 @@
+#include <afina/Storage.h>
+#include <afina/execute/Cas.h>
+
+#include <utility>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "cas" is a check and set operation which means "store this data but only if no one else
+// has updated since I last fetched it."
+void Cas::Run(Storage &storage, const std::string &key, uint64_t version, std::string &&args, Response &out) {
+    if (storage.CompareAndSet(key, std::move(args), version)) {
+        out.SetStatus(Response::Status::Stored);
+        out.SetVersion(version);
+        out.Append("STORED");
+    } else if (version == 0) {
+        out.SetStatus(Response::Status::NotFound);
+        out.Append("NOT_FOUND");
+    } else {
+        out.SetStatus(Response::Status::Exists);
+        out.Append("EXISTS");
+    }
+}
+
+// See Cas.h
+void Cas::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _key, _version, std::string(args), out);
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,18 @@
+#include <afina/Storage.h>
+#include <afina/execute/Delete.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "delete" removes the item with given key, if there is any.
+void Delete::Run(Storage &storage, const std::string &key, Response &out) {
+    bool deleted = storage.Delete(key);
+    out.SetStatus(deleted ? Response::Status::Deleted : Response::Status::NotFound);
+    out.Append(deleted ? "DELETED" : "NOT_FOUND");
+}
+
+// See Delete.h
+void Delete::Execute(Storage &storage, const std::string &args, Response &out) { Run(storage, _key, out); }
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,24 @@
+#include <afina/Storage.h>
+#include <afina/execute/FlushAll.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "flush_all" invalidates all existing items.
+void FlushAll::Run(Storage &storage, int32_t delay, Response &out) {
+    if (delay != 0) {
+        // Items can't be dropped later, doing it right away would lose them before the client expects
+        out.SetStatus(Response::Status::Refused);
+        out.Append("CLIENT_ERROR delayed flush is not supported");
+        return;
+    }
+    storage.Clear();
+    out.SetStatus(Response::Status::Ok);
+    out.Append("OK");
+}
+
+// See FlushAll.h
+void FlushAll::Execute(Storage &storage, const std::string &args, Response &out) { Run(storage, _delay, out); }
+
+} // namespace Execute
+} // namespace Afina
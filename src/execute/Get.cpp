@@ -1,9 +1,7 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <utility>
 
 namespace Afina {
 namespace Execute {
@@ -12,33 +10,44 @@ namespace Execute {
 
 Each item sent by the server looks like this:
 
-VALUE <key> <flags> <bytes>\r\n
+VALUE <key> <flags> <bytes> [<cas unique>]\r\n
 <data block>\r\n
 
+where <cas unique> is sent in response to "gets" only.
+
 After all the items have been transmitted, the server sends the string
 "END\r\n"
 to indicate the end of response.
 
 */
 
-void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::stringstream keyStream;
-    copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
-    std::cout << "Get(" << keyStream.str() << ")" << std::endl;
-
-    std::stringstream outStream;
-
+void Get::Run(Storage &storage, const std::string *keys, std::size_t count, bool versions, Response &out) {
     std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
+    uint64_t version;
+    out.SetStatus(Response::Status::NotFound);
+    for (std::size_t i = 0; i < count; i++) {
+        const std::string &key = keys[i];
+        if (!storage.Get(key, value, &version))
             continue;
-        value = value.substr(0, value.size() - 2);
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+        if (out.GetStatus() != Response::Status::Found) {
+            out.SetStatus(Response::Status::Found);
+            out.SetVersion(version);
+        }
+
+        // Stored value already ends with \r\n, which is the end of the data block
+        out.Append("VALUE ").Append(key).Append(" 0 ").Append(uint64_t(value.size() - 2));
+        if (versions) {
+            out.Append(" ").Append(version);
+        }
+        out.Append("\r\n");
+        out.AttachItem(std::move(value));
     }
-    outStream << "END"; // networking layer should add the last \r\n
+    out.Append("END"); // networking layer should add the last \r\n
+}
 
-    out = outStream.str();
+// See Get.h
+void Get::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _keys.data(), _keys.size(), _versions, out);
 }
 
 } // namespace Execute
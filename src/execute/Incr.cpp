@@ -0,0 +1,85 @@
+#include <afina/Storage.h>
+#include <afina/execute/Incr.h>
+
+#include <limits>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Parses value of the item, the one with trailing \r\n
+bool parse_counter(const std::string &value, uint64_t &result) {
+    if (value.size() <= 2) {
+        return false;
+    }
+
+    result = 0;
+    for (std::size_t i = 0; i < value.size() - 2; i++) {
+        char c = value[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        uint64_t digit = c - '0';
+        if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+    return true;
+}
+
+} // namespace
+
+// memcached protocol: "incr" and "decr" change value of the existing item, which must be a decimal
+// representation of 64-bit unsigned integer.
+void Incr::Run(Storage &storage, const std::string &key, uint64_t delta, uint64_t initial, bool create, bool decrement,
+               Response &out) {
+    bool numeric = true;
+    uint64_t result = 0;
+    auto change = [delta, decrement, &numeric, &result](std::string &value) {
+        uint64_t current;
+        if (!parse_counter(value, current)) {
+            numeric = false;
+            return false;
+        }
+
+        if (!decrement) {
+            result = current + delta;
+        } else {
+            result = (current > delta) ? current - delta : 0;
+        }
+        value = std::to_string(result);
+        value += "\r\n";
+        return true;
+    };
+
+    uint64_t version;
+    if (!storage.Update(key, change, &version)) {
+        if (create && storage.PutIfAbsent(key, std::to_string(initial) + "\r\n", &version)) {
+            out.SetStatus(Response::Status::Counted);
+            out.SetVersion(version);
+            out.SetCounter(initial);
+            out.Append(initial);
+        } else {
+            out.SetStatus(Response::Status::NotFound);
+            out.Append("NOT_FOUND");
+        }
+    } else if (!numeric) {
+        out.SetStatus(Response::Status::NonNumeric);
+        out.Append("CLIENT_ERROR cannot increment or decrement non-numeric value");
+    } else {
+        out.SetStatus(Response::Status::Counted);
+        out.SetVersion(version);
+        out.SetCounter(result);
+        out.Append(result);
+    }
+}
+
+// See Incr.h
+void Incr::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _key, _delta, _initial, _create, _decrement, out);
+}
+
+} // namespace Execute
+} // namespace Afina
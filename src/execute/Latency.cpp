@@ -0,0 +1,154 @@
+#include <afina/execute/Latency.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Afina {
+namespace Execute {
+
+constexpr std::size_t Latency::Histogram::SubBuckets;
+constexpr std::size_t Latency::Histogram::Buckets;
+
+std::atomic<uint32_t> Latency::_sampling(0);
+
+namespace {
+
+// Sets of the running threads and counters left by finished ones
+class Registry {
+public:
+    void Attach(Latency::Set *set) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sets.push_back(set);
+    }
+
+    void Detach(Latency::Set *set) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sets.erase(std::find(_sets.begin(), _sets.end(), set));
+        _add(_retired, *set);
+    }
+
+    void Collect(Latency::Set &result) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _add(result, _retired);
+        for (auto set : _sets) {
+            _add(result, *set);
+        }
+    }
+
+private:
+    static void _add(Latency::Set &to, const Latency::Set &from) {
+        for (std::size_t kind = 0; kind < Latency::Kinds; kind++) {
+            for (std::size_t stage = 0; stage < Latency::Stages; stage++) {
+                to.histograms[kind][stage].Add(from.histograms[kind][stage]);
+            }
+        }
+    }
+
+    std::mutex _mutex;
+    std::vector<Latency::Set *> _sets;
+    Latency::Set _retired;
+};
+
+// Registry is never destroyed: threads could finish after static objects are gone
+Registry &registry() {
+    static Registry *instance = new Registry;
+    return *instance;
+}
+
+// Set of the calling thread, created once thread measures anything
+class Local {
+public:
+    ~Local() {
+        if (_set) {
+            registry().Detach(_set.get());
+        }
+    }
+
+    Latency::Set &Get() {
+        if (!_set) {
+            _set.reset(new Latency::Set);
+            registry().Attach(_set.get());
+        }
+        return *_set;
+    }
+
+private:
+    std::unique_ptr<Latency::Set> _set;
+};
+
+thread_local Local local;
+
+} // namespace
+
+// See Latency.h
+Latency::Histogram::Histogram() : _count(0), _sum(0), _max(0) {
+    for (auto &count : _counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+// See Latency.h
+void Latency::Histogram::Record(uint64_t value) {
+    // The only writer, so plain load and store are enough and never stall on a locked bus
+    std::atomic<uint64_t> &count = _counts[Layout::Index(value)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _sum.store(_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value > _max.load(std::memory_order_relaxed)) {
+        _max.store(value, std::memory_order_relaxed);
+    }
+}
+
+// See Latency.h
+void Latency::Histogram::Add(const Histogram &other) {
+    for (std::size_t i = 0; i < Buckets; i++) {
+        _counts[i].store(_counts[i].load(std::memory_order_relaxed) + other._counts[i].load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    }
+    _count.store(Count() + other.Count(), std::memory_order_relaxed);
+    _sum.store(Sum() + other.Sum(), std::memory_order_relaxed);
+    _max.store(std::max(Max(), other.Max()), std::memory_order_relaxed);
+}
+
+// See Latency.h
+uint64_t Latency::Histogram::Percentile(double p) const {
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p * Count())));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < Buckets; i++) {
+        seen += _counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(Layout::Highest(i), Max());
+        }
+    }
+    return Max();
+}
+
+// See Latency.h
+void Latency::SetSampling(uint32_t every) { _sampling.store(every, std::memory_order_relaxed); }
+
+// See Latency.h
+void Latency::Record(Request::Kind kind, Stage stage, uint64_t nanoseconds) {
+    local.Get().Of(kind, stage).Record(nanoseconds);
+}
+
+// See Latency.h
+void Latency::Collect(Set &result) { registry().Collect(result); }
+
+// See Latency.h
+const char *Latency::Name(Stage stage) {
+    switch (stage) {
+    case Stage::Parse:
+        return "parse";
+    case Stage::Storage:
+        return "storage";
+    case Stage::Write:
+        return "write";
+    }
+    return "";
+}
+
+} // namespace Execute
+} // namespace Afina
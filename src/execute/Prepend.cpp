@@ -0,0 +1,26 @@
+#include <afina/Storage.h>
+#include <afina/execute/Prepend.h>
+
+#include <utility>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "prepend" means "add this data to an existing key before existing data".
+void Prepend::Run(Storage &storage, const std::string &key, std::string &&args, Response &out) {
+    // Both values end with \r\n, only the one of the existing value must stay
+    args.resize(args.size() - 2);
+    uint64_t version;
+    bool stored = storage.Prepend(key, std::move(args), &version);
+    out.SetStatus(stored ? Response::Status::Stored : Response::Status::NotStored);
+    out.SetVersion(version);
+    out.Append(stored ? "STORED" : "NOT_STORED");
+}
+
+// See Prepend.h
+void Prepend::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _key, std::string(args), out);
+}
+
+} // namespace Execute
+} // namespace Afina
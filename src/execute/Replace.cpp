@@ -1,7 +1,7 @@
 #include <afina/Storage.h>
 #include <afina/execute/Replace.h>
 
-#include <iostream>
+#include <utility>
 
 namespace Afina {
 namespace Execute {
@@ -9,15 +9,17 @@ namespace Execute {
 // memcached protocol:  "replace" means "store this data, but only if the server *does*
 // already hold data for this key".
 
-void Replace::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Replace(" << _key << "): " << args << std::endl;
-    std::string value;
-    if (storage.Get(_key, value)) {
-        storage.Set(_key, args);
-        out = "STORED";
-    } else {
-        out = "NOT_STORED";
-    }
+void Replace::Run(Storage &storage, const std::string &key, std::string &&args, Response &out) {
+    uint64_t version;
+    bool stored = storage.Set(key, std::move(args), &version);
+    out.SetStatus(stored ? Response::Status::Stored : Response::Status::NotStored);
+    out.SetVersion(version);
+    out.Append(stored ? "STORED" : "NOT_STORED");
+}
+
+// See Replace.h
+void Replace::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _key, std::string(args), out);
 }
 
 } // namespace Execute
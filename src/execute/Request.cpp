@@ -0,0 +1,126 @@
+#include <afina/execute/Request.h>
+
+#include <afina/execute/Add.h>
+#include <afina/execute/Append.h>
+#include <afina/execute/Cas.h>
+#include <afina/execute/Delete.h>
+#include <afina/execute/FlushAll.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Incr.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
+#include <afina/execute/Set.h>
+#include <afina/execute/Stats.h>
+#include <afina/execute/Touch.h>
+
+#include <utility>
+
+namespace Afina {
+namespace Execute {
+
+// See Request.h
+const char *Request::Name(Kind kind) {
+    switch (kind) {
+    case Kind::Set:
+        return "set";
+    case Kind::Add:
+        return "add";
+    case Kind::Replace:
+        return "replace";
+    case Kind::Cas:
+        return "cas";
+    case Kind::Append:
+        return "append";
+    case Kind::Prepend:
+        return "prepend";
+    case Kind::Get:
+        return "get";
+    case Kind::Gets:
+        return "gets";
+    case Kind::Delete:
+        return "delete";
+    case Kind::Incr:
+        return "incr";
+    case Kind::Decr:
+        return "decr";
+    case Kind::Touch:
+        return "touch";
+    case Kind::FlushAll:
+        return "flush_all";
+    case Kind::Stats:
+        return "stats";
+    case Kind::None:
+        break;
+    }
+    return "";
+}
+
+// See Request.h
+void Request::Reset() {
+    kind = Kind::None;
+    flags = 0;
+    expire = 0;
+    delta = 0;
+    initial = 0;
+    version = 0;
+    create = false;
+    _keys_count = 0;
+}
+
+// See Request.h
+void Request::AddKey(const char *data, std::size_t size) {
+    if (_keys_count == _keys.size()) {
+        _keys.emplace_back();
+    }
+    _keys[_keys_count++].assign(data, size);
+}
+
+// See Request.h
+void Request::Execute(Storage &storage, std::string &args, Response &out) const {
+    switch (kind) {
+    case Kind::Set:
+        Set::Run(storage, Key(), std::move(args), out);
+        break;
+    case Kind::Add:
+        Add::Run(storage, Key(), std::move(args), out);
+        break;
+    case Kind::Replace:
+        Replace::Run(storage, Key(), std::move(args), out);
+        break;
+    case Kind::Cas:
+        Cas::Run(storage, Key(), version, std::move(args), out);
+        break;
+    case Kind::Append:
+        Append::Run(storage, Key(), std::move(args), out);
+        break;
+    case Kind::Prepend:
+        Prepend::Run(storage, Key(), std::move(args), out);
+        break;
+    case Kind::Get:
+    case Kind::Gets:
+        Get::Run(storage, Keys(), KeysCount(), kind == Kind::Gets, out);
+        break;
+    case Kind::Delete:
+        Delete::Run(storage, Key(), out);
+        break;
+    case Kind::Incr:
+    case Kind::Decr:
+        Incr::Run(storage, Key(), delta, initial, create, kind == Kind::Decr, out);
+        break;
+    case Kind::Touch:
+        Touch::Run(storage, Key(), expire, out);
+        break;
+    case Kind::FlushAll:
+        FlushAll::Run(storage, expire, out);
+        break;
+    case Kind::Stats:
+        // Group of statistics is optional
+        Stats::Run(storage, KeysCount() > 0 ? Key() : std::string(), out);
+        break;
+    case Kind::None:
+        break;
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
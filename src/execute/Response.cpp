@@ -0,0 +1,123 @@
+#include <afina/execute/Response.h>
+
+namespace Afina {
+namespace Execute {
+
+const std::size_t Response::Part::Buffer;
+
+// See Response.h
+Response &Response::Append(const char *data, std::size_t size) {
+    if (size == 0) {
+        return *this;
+    }
+
+    if (_parts.empty() || _parts.back().value != Part::Buffer) {
+        _parts.push_back(Part{Part::Buffer, _buffer.size(), 0});
+    }
+    _buffer.append(data, size);
+    _parts.back().size += size;
+    _size += size;
+    return *this;
+}
+
+// See Response.h
+Response &Response::Append(uint64_t value) {
+    // Digits are written from the end, 20 is enough for the largest 64-bit number
+    char digits[20];
+    char *begin = digits + sizeof(digits);
+    do {
+        *--begin = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return Append(begin, digits + sizeof(digits) - begin);
+}
+
+// See Response.h
+Response &Response::Attach(std::string &&value, std::size_t size) {
+    if (size == 0) {
+        return *this;
+    }
+
+    _size += size;
+    _parts.push_back(Part{_values.size(), 0, size});
+    _values.push_back(std::move(value));
+    return *this;
+}
+
+// See Response.h
+Response &Response::AttachItem(std::string &&value) {
+    if (_item == Part::Buffer && !value.empty()) {
+        _item = _values.size();
+    }
+    return Attach(std::move(value));
+}
+
+// See Response.h
+Response &Response::Append(Response &&other) {
+    for (auto &part : other._parts) {
+        if (part.value == Part::Buffer) {
+            Append(other._buffer.data() + part.offset, part.size);
+        } else {
+            Attach(std::move(other._values[part.value]), part.size);
+        }
+    }
+    other.Clear();
+    return *this;
+}
+
+// See Response.h
+void Response::Clear() {
+    _size = 0;
+    _status = Status::None;
+    _version = 0;
+    _counter = 0;
+    _item = Part::Buffer;
+    _buffer.clear();
+    _values.clear();
+    _parts.clear();
+}
+
+// See Response.h
+std::size_t Response::Gather(std::size_t offset, Segment *segments, std::size_t count) const {
+    std::size_t filled = 0;
+    for (auto &part : _parts) {
+        if (filled == count) {
+            break;
+        }
+        if (offset >= part.size) {
+            offset -= part.size;
+            continue;
+        }
+
+        Segment segment = _segment(part);
+        segments[filled].data = segment.data + offset;
+        segments[filled].size = segment.size - offset;
+        filled++;
+        offset = 0;
+    }
+    return filled;
+}
+
+// See Response.h
+void Response::CopyTo(std::string &out) const {
+    out.reserve(out.size() + _size);
+    for (auto &part : _parts) {
+        Segment segment = _segment(part);
+        out.append(segment.data, segment.size);
+    }
+}
+
+// See Response.h
+std::string Response::Str() const {
+    std::string result;
+    CopyTo(result);
+    return result;
+}
+
+Response::Segment Response::_segment(const Part &part) const {
+    const std::string &source = (part.value == Part::Buffer) ? _buffer : _values[part.value];
+    return Segment{source.data() + part.offset, part.size};
+}
+
+} // namespace Execute
+} // namespace Afina
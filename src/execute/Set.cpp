@@ -1,16 +1,23 @@
 #include <afina/Storage.h>
 #include <afina/execute/Set.h>
 
-#include <iostream>
+#include <utility>
 
 namespace Afina {
 namespace Execute {
 
 // memcached protocol: "set" means "store this data".
-void Set::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Set(" << _key << "): " << args << std::endl;
-    storage.Put(_key, args);
-    out = "STORED";
+void Set::Run(Storage &storage, const std::string &key, std::string &&args, Response &out) {
+    uint64_t version;
+    storage.Put(key, std::move(args), &version);
+    out.SetStatus(Response::Status::Stored);
+    out.SetVersion(version);
+    out.Append("STORED");
+}
+
+// See Set.h
+void Set::Execute(Storage &storage, const std::string &args, Response &out) {
+    Run(storage, _key, std::string(args), out);
 }
 
 } // namespace Execute
@@ -1,14 +1,82 @@
 #include <afina/Storage.h>
+#include <afina/execute/Latency.h>
 #include <afina/execute/Stats.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <memory>
 
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+namespace {
+
+// Writes "STAT <kind>:<stage>:<name> <value>" line
+void stat(Response &out, Request::Kind kind, Latency::Stage stage, const char *name, uint64_t value) {
+    out.Append("STAT ").Append(Request::Name(kind)).Append(":").Append(Latency::Name(stage)).Append(":");
+    out.Append(name).Append(" ").Append(value).Append("\r\n");
+}
+
+void commands(const Latency::Set &latency, Response &out) {
+    out.Append("STAT sampling ").Append(uint64_t(Latency::Sampling())).Append("\r\n");
+    for (std::size_t kind = 1; kind < Latency::Kinds; kind++) {
+        // Every measured command is parsed, while write is skipped by the ones client wants no response for
+        const Latency::Histogram &parse = latency.histograms[kind][std::size_t(Latency::Stage::Parse)];
+        if (parse.Count() == 0) {
+            continue;
+        }
+
+        out.Append("STAT ").Append(Request::Name(Request::Kind(kind))).Append(":measured ").Append(parse.Count());
+        out.Append("\r\n");
+        for (std::size_t stage = 0; stage < Latency::Stages; stage++) {
+            const Latency::Histogram &histogram = latency.histograms[kind][stage];
+            uint64_t mean = histogram.Count() == 0 ? 0 : histogram.Sum() / histogram.Count();
+            stat(out, Request::Kind(kind), Latency::Stage(stage), "mean_ns", mean);
+        }
+    }
+}
+
+void latency(const Latency::Set &latency, Response &out) {
+    for (std::size_t kind = 1; kind < Latency::Kinds; kind++) {
+        for (std::size_t stage = 0; stage < Latency::Stages; stage++) {
+            const Latency::Histogram &histogram = latency.histograms[kind][stage];
+            if (histogram.Count() == 0) {
+                continue;
+            }
+            stat(out, Request::Kind(kind), Latency::Stage(stage), "p50_ns", histogram.Percentile(0.5));
+            stat(out, Request::Kind(kind), Latency::Stage(stage), "p90_ns", histogram.Percentile(0.9));
+            stat(out, Request::Kind(kind), Latency::Stage(stage), "p99_ns", histogram.Percentile(0.99));
+            stat(out, Request::Kind(kind), Latency::Stage(stage), "p999_ns", histogram.Percentile(0.999));
+            stat(out, Request::Kind(kind), Latency::Stage(stage), "max_ns", histogram.Max());
+        }
+    }
+}
+
+} // namespace
+
+// memcached protocol: "stats" reports server statistics, "stats <group>" reports the group of them.
+void Stats::Run(Storage &storage, const std::string &group, Response &out) {
+    if (group.empty()) {
+        out.Append("END");
+        return;
+    }
+
+    if (group != "commands" && group != "latency") {
+        out.Append("CLIENT_ERROR unknown stats group");
+        return;
+    }
+
+    // Histograms of all the threads are too large for the stack
+    std::unique_ptr<Latency::Set> set(new Latency::Set);
+    Latency::Collect(*set);
+    if (group == "commands") {
+        commands(*set, out);
+    } else {
+        latency(*set, out);
+    }
+    out.Append("END");
+}
+
+// See Stats.h
+void Stats::Execute(Storage &storage, const std::string &args, Response &out) { Run(storage, _group, out); }
 
 } // namespace Execute
 } // namespace Afina
@@ -0,0 +1,18 @@
+#include <afina/Storage.h>
+#include <afina/execute/Touch.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "touch" is used to update the expiration time of an existing item without fetching it.
+void Touch::Run(Storage &storage, const std::string &key, int32_t expire, Response &out) {
+    bool touched = storage.Touch(key);
+    out.SetStatus(touched ? Response::Status::Touched : Response::Status::NotFound);
+    out.Append(touched ? "TOUCHED" : "NOT_FOUND");
+}
+
+// See Touch.h
+void Touch::Execute(Storage &storage, const std::string &args, Response &out) { Run(storage, _key, _expire, out); }
+
+} // namespace Execute
+} // namespace Afina
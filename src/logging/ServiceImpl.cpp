@@ -5,6 +5,7 @@
 #include <unordered_set>
 #include <utility>
 
+#include <spdlog/async_logger.h>
 #include <spdlog/sinks/dist_sink.h>
 #include <spdlog/sinks/file_sinks.h>
 #include <spdlog/sinks/stdout_sinks.h>
@@ -165,7 +166,13 @@ void ServiceImpl::Start() {
         }
 
         // Create logger
-        std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::logger>(name, ptr);
+        std::shared_ptr<spdlog::logger> logger;
+        if (pLogger.async) {
+            logger = std::make_shared<spdlog::async_logger>(name, ptr, 8192,
+                                                            spdlog::async_overflow_policy::discard_log_msg);
+        } else {
+            logger = std::make_shared<spdlog::logger>(name, ptr);
+        }
         logger->set_level(lvl);
         logger->set_pattern(pLogger.format);
         logger->flush_on(spdlog::level::err);
@@ -11,6 +11,7 @@
 
 #include <afina/Storage.h>
 #include <afina/Version.h>
+#include <afina/execute/Latency.h>
 #include <afina/logging/Service.h>
 #include <afina/network/Server.h>
 
@@ -43,6 +44,14 @@ public:
         logger.level = Logging::Logger::Level::DEBUG;
         logger.appenders.push_back("console");
         logger.format = "[%H:%M:%S %z] [thread %t] [%n] [%l] %v";
+
+        // Traces of executed commands, see protocol/Session.h
+        Logging::Logger &tracer = logConfig->loggers["execute"];
+        tracer.level = Logging::Logger::Level::TRACE;
+        tracer.appenders.push_back("console");
+        tracer.format = logger.format;
+        tracer.async = true;
+
         logService.reset(new Logging::ServiceImpl(logConfig));
 
         // Step 1: configure storage
@@ -78,6 +87,11 @@ public:
         } else {
             throw std::runtime_error("Unknown network type");
         }
+
+        // Step 3: Configure command latency measurement, see execute/Latency.h
+        if (options.count("latency-sampling") > 0) {
+            Afina::Execute::Latency::SetSampling(options["latency-sampling"].as<uint32_t>());
+        }
     }
 
     // Start services in correct order
@@ -132,6 +146,8 @@ int main(int argc, char **argv) {
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("latency-sampling", "Measure latency of every N-th command, 0 to turn it off",
+                              cxxopts::value<uint32_t>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
@@ -0,0 +1,174 @@
+#include "Buffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <new>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+
+constexpr std::size_t Block::Size;
+constexpr std::size_t Block::Capacity;
+constexpr int Buffer::MaxIov;
+
+// See Buffer.h
+BlockPool::~BlockPool() {
+    while (_free != nullptr) {
+        Block *next = _free->next;
+        delete _free;
+        _free = next;
+    }
+}
+
+// See Buffer.h
+Block *BlockPool::Acquire() {
+    Block *result = _free;
+    if (result != nullptr) {
+        _free = result->next;
+        _cached--;
+    } else {
+        result = new Block;
+    }
+
+    result->next = nullptr;
+    result->begin = 0;
+    result->end = 0;
+    return result;
+}
+
+// See Buffer.h
+void BlockPool::Release(Block *block) {
+    if (_cached >= _max_cached) {
+        delete block;
+        return;
+    }
+
+    block->next = _free;
+    _free = block;
+    _cached++;
+}
+
+// See Buffer.h
+BlockPool &BlockPool::Local() {
+    static thread_local BlockPool pool;
+    return pool;
+}
+
+// See Buffer.h
+void Buffer::Consume(std::size_t n) {
+    assert(n <= _size);
+    _size -= n;
+
+    while (n > 0) {
+        std::size_t avail = _head->end - _head->begin;
+        if (n < avail) {
+            _head->begin += n;
+            return;
+        }
+
+        n -= avail;
+        if (_head == _tail) {
+            // Last block, rewind it instead of release: most likely new data arrives soon
+            _head->begin = _head->end = 0;
+        } else {
+            Block *next = _head->next;
+            BlockPool::Local().Release(_head);
+            _head = next;
+        }
+    }
+}
+
+// See Buffer.h
+char *Buffer::Prepare(std::size_t &size) {
+    Block *tail = _writable();
+    size = Block::Capacity - tail->end;
+    return tail->data + tail->end;
+}
+
+// See Buffer.h
+void Buffer::Commit(std::size_t n) {
+    assert(_tail != nullptr && _tail->end + n <= Block::Capacity);
+    _tail->end += n;
+    _size += n;
+}
+
+// See Buffer.h
+void Buffer::Append(const char *data, std::size_t size) {
+    while (size > 0) {
+        std::size_t avail;
+        char *dst = Prepare(avail);
+        std::size_t n = std::min(avail, size);
+        std::memcpy(dst, data, n);
+        Commit(n);
+
+        data += n;
+        size -= n;
+    }
+}
+
+// See Buffer.h
+ssize_t Buffer::ReadFrom(int fd) {
+    std::size_t size;
+    char *dst = Prepare(size);
+    ssize_t result = read(fd, dst, size);
+    if (result > 0) {
+        Commit(result);
+    }
+    return result;
+}
+
+// See Buffer.h
+ssize_t Buffer::WriteTo(int fd) {
+    static_assert(MaxIov <= IOV_MAX, "writev could not accept that many blocks");
+    struct iovec iov[MaxIov];
+    int iovcnt = 0;
+    for (Block *block = _head; block != nullptr && iovcnt < MaxIov; block = block->next) {
+        if (block->end > block->begin) {
+            iov[iovcnt].iov_base = block->data + block->begin;
+            iov[iovcnt].iov_len = block->end - block->begin;
+            iovcnt++;
+        }
+    }
+
+    if (iovcnt == 0) {
+        return 0;
+    }
+
+    ssize_t result = writev(fd, iov, iovcnt);
+    if (result > 0) {
+        Consume(result);
+    }
+    return result;
+}
+
+// See Buffer.h
+void Buffer::Clear() {
+    BlockPool &pool = BlockPool::Local();
+    while (_head != nullptr) {
+        Block *next = _head->next;
+        pool.Release(_head);
+        _head = next;
+    }
+    _tail = nullptr;
+    _size = 0;
+}
+
+// See Buffer.h
+Block *Buffer::_writable() {
+    if (_tail == nullptr) {
+        _head = _tail = BlockPool::Local().Acquire();
+    } else if (_tail->end == Block::Capacity) {
+        Block *block = BlockPool::Local().Acquire();
+        _tail->next = block;
+        _tail = block;
+    }
+    return _tail;
+}
+
+} // namespace Network
+} // namespace Afina
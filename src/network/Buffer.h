@@ -0,0 +1,158 @@
+#ifndef AFINA_NETWORK_BUFFER_H
+#define AFINA_NETWORK_BUFFER_H
+
+#include <cstddef>
+#include <string>
+
+#include <sys/types.h>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Fixed size chunk of memory
+ * Buffers are built as a chain of blocks. Bytes in [begin, end) are filled but not consumed yet,
+ * [end, Capacity) is free space to write into
+ */
+struct Block {
+    static constexpr std::size_t Size = 16 * 1024;
+    static constexpr std::size_t Capacity = Size - sizeof(Block *) - 2 * sizeof(std::size_t);
+
+    Block *next;
+    std::size_t begin;
+    std::size_t end;
+    char data[Capacity];
+};
+
+/**
+ * # Cache of free blocks
+ * Keeps released blocks in a free list, so that steady state traffic doesn't touch malloc. Number of
+ * cached blocks is bounded, everything above the limit goes back to the system.
+ *
+ * Not thread safe, each thread works with its own instance, see Local()
+ */
+class BlockPool {
+public:
+    explicit BlockPool(std::size_t max_cached = 64) : _free(nullptr), _cached(0), _max_cached(max_cached) {}
+    ~BlockPool();
+
+    /**
+     * Returns empty block, either cached one or freshly allocated
+     */
+    Block *Acquire();
+
+    /**
+     * Returns block back to the pool. Block must not be used by caller after that
+     */
+    void Release(Block *block);
+
+    /**
+     * Number of blocks currently cached
+     */
+    inline std::size_t Cached() const { return _cached; }
+
+    /**
+     * Pool of the calling thread
+     */
+    static BlockPool &Local();
+
+private:
+    BlockPool(const BlockPool &) = delete;
+    BlockPool &operator=(const BlockPool &) = delete;
+
+    // Single linked list of free blocks
+    Block *_free;
+    std::size_t _cached;
+    std::size_t _max_cached;
+};
+
+/**
+ * # Chained byte buffer
+ * Data gets appended to the tail block and consumed from the head one by advancing offsets, so
+ * no bytes are ever moved around. Once head block is fully consumed it returns to the pool of
+ * the calling thread; when the whole buffer drains its last block rewinds and gets reused.
+ *
+ * Buffer doesn't bind to any particular pool, so it could migrate between threads together with
+ * its connection.
+ */
+class Buffer {
+public:
+    Buffer() : _head(nullptr), _tail(nullptr), _size(0) {}
+    ~Buffer() { Clear(); }
+
+    /**
+     * Total number of bytes available to consume
+     */
+    inline std::size_t Size() const { return _size; }
+    inline bool Empty() const { return _size == 0; }
+
+    /**
+     * Start of the first contiguous span of unconsumed bytes, nullptr if buffer is empty
+     */
+    inline const char *Data() const { return _size == 0 ? nullptr : _head->data + _head->begin; }
+
+    /**
+     * Size of the span returned by Data()
+     */
+    inline std::size_t ContiguousSize() const { return _size == 0 ? 0 : _head->end - _head->begin; }
+
+    /**
+     * Marks n bytes from the buffer start as consumed, n must not exceed Size()
+     */
+    void Consume(std::size_t n);
+
+    /**
+     * Returns free space at the buffer end to write data into, chaining new block if there is no
+     * space left. Bytes written there become visible only after Commit()
+     *
+     * @param size output parameter, number of bytes available at the returned address
+     */
+    char *Prepare(std::size_t &size);
+
+    /**
+     * Appends n bytes written into the space returned by the last Prepare() call
+     */
+    void Commit(std::size_t n);
+
+    /**
+     * Copies given bytes to the buffer end, chaining as many blocks as needed
+     */
+    void Append(const char *data, std::size_t size);
+    inline void Append(const std::string &data) { Append(data.data(), data.size()); }
+
+    /**
+     * Reads available data from the descriptor into the free space of the tail block, chaining new
+     * block if there is no space left. Returns result of read(2)
+     */
+    ssize_t ReadFrom(int fd);
+
+    /**
+     * Writes as much of the buffer as possible into the descriptor with a single writev(2) call over
+     * the chained blocks and consumes written bytes. Returns result of writev(2)
+     */
+    ssize_t WriteTo(int fd);
+
+    /**
+     * Drops all data and returns blocks to the pool
+     */
+    void Clear();
+
+private:
+    Buffer(const Buffer &) = delete;
+    Buffer &operator=(const Buffer &) = delete;
+
+    // Returns block having some free space at the end of chain
+    Block *_writable();
+
+    // Max number of blocks written by single WriteTo() call, keeps iovec array on stack small
+    static constexpr int MaxIov = 64;
+
+    Block *_head;
+    Block *_tail;
+    std::size_t _size;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_BUFFER_H
@@ -0,0 +1,94 @@
+#ifndef AFINA_NETWORK_OBJECT_POOL_H
+#define AFINA_NETWORK_OBJECT_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Cache of memory for objects of type T
+ * Destroyed objects leave their memory in a free list, so that next Create() doesn't touch malloc.
+ * Number of cached slots is bounded, everything above the limit goes back to the system.
+ *
+ * Not thread safe, caller must provide synchronization if pool is shared
+ */
+template <typename T> class ObjectPool {
+public:
+    explicit ObjectPool(std::size_t max_cached = 1024) : _free(nullptr), _cached(0), _max_cached(max_cached) {}
+
+    ~ObjectPool() {
+        while (_free != nullptr) {
+            Slot *next = _free->next;
+            ::operator delete(_free);
+            _free = next;
+        }
+    }
+
+    /**
+     * Constructs new object in the cached memory if there is any or in the newly allocated one
+     */
+    template <typename... Ta> T *Create(Ta &&... args) {
+        void *memory;
+        if (_free != nullptr) {
+            memory = _free;
+            _free = _free->next;
+            _cached--;
+        } else {
+            memory = ::operator new(sizeof(Slot));
+        }
+
+        try {
+            return new (memory) T(std::forward<Ta>(args)...);
+        } catch (...) {
+            _put(static_cast<Slot *>(memory));
+            throw;
+        }
+    }
+
+    /**
+     * Destroys object created by this pool and keeps its memory for future use
+     */
+    void Destroy(T *object) {
+        object->~T();
+        _put(reinterpret_cast<Slot *>(object));
+    }
+
+    /**
+     * Number of slots currently cached
+     */
+    inline std::size_t Cached() const { return _cached; }
+
+private:
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    union Slot {
+        Slot *next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    void _put(Slot *slot) {
+        if (_cached >= _max_cached) {
+            ::operator delete(slot);
+            return;
+        }
+
+        slot->next = _free;
+        _free = slot;
+        _cached++;
+    }
+
+    // Single linked list of free slots
+    Slot *_free;
+    std::size_t _cached;
+    std::size_t _max_cached;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_OBJECT_POOL_H
@@ -0,0 +1,59 @@
+#include "Reader.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/uio.h>
+
+#include "network/Buffer.h"
+#include "protocol/Session.h"
+
+namespace Afina {
+namespace Network {
+
+// See Reader.h
+ssize_t ReadRequests(int fd, Buffer &buffer, Protocol::Session &session, Execute::Response &out) {
+    // Data block could go directly to the session only if nothing is buffered in front of it
+    std::size_t window_size = 0;
+    char *window = buffer.Empty() ? session.Window(window_size) : nullptr;
+
+    ssize_t result;
+    if (window == nullptr) {
+        result = buffer.ReadFrom(fd);
+    } else {
+        std::size_t free_size;
+        struct iovec iov[2];
+        iov[0].iov_base = window;
+        iov[0].iov_len = window_size;
+        iov[1].iov_base = buffer.Prepare(free_size);
+        iov[1].iov_len = free_size;
+
+        result = readv(fd, iov, 2);
+        if (result > 0) {
+            std::size_t direct = std::min<std::size_t>(result, window_size);
+            session.Commit(direct);
+            buffer.Commit(result - direct);
+        }
+    }
+
+    if (result <= 0) {
+        return result;
+    }
+
+    // Everything the read brought is parsed first, so that all commands it completes run as a single batch
+    try {
+        while (!buffer.Empty()) {
+            std::size_t size = buffer.ContiguousSize();
+            session.Parse(buffer.Data(), size);
+            buffer.Consume(size);
+        }
+    } catch (std::runtime_error &ex) {
+        // Commands received before the broken one are still executed and answered, connection is closed after
+        session.Fail(ex.what());
+    }
+    session.Flush(out);
+    return result;
+}
+
+} // namespace Network
+} // namespace Afina
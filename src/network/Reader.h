@@ -0,0 +1,31 @@
+#ifndef AFINA_NETWORK_READER_H
+#define AFINA_NETWORK_READER_H
+
+#include <sys/types.h>
+
+namespace Afina {
+namespace Execute {
+class Response;
+} // namespace Execute
+namespace Protocol {
+class Session;
+} // namespace Protocol
+namespace Network {
+
+class Buffer;
+
+/**
+ * Reads available data from the descriptor and feeds it to the session, responses of the completed commands are
+ * appended to out. If session waits for the data block it has memory for, the block is read right there with the
+ * same readv(2) call that puts whatever follows into the buffer, so large values aren't copied on the way to
+ * storage. All commands completed by the read are executed as a single storage batch. Returns result of the read.
+ *
+ * If client breaks the protocol, commands received before the broken one are executed and answered as usual, then
+ * session gets closed with the Error() set. Network layer sends out and closes connection as if client asked to quit
+ */
+ssize_t ReadRequests(int fd, Buffer &buffer, Protocol::Session &session, Execute::Response &out);
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_READER_H
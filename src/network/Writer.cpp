@@ -0,0 +1,78 @@
+#include "Writer.h"
+
+#include <cerrno>
+#include <climits>
+
+#include <sys/uio.h>
+
+#include <afina/execute/Response.h>
+
+#include "network/Buffer.h"
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+// Max number of segments written by single call, keeps iovec array small enough for coroutine stacks
+constexpr std::size_t MaxIov = 64;
+
+} // namespace
+
+// See Writer.h
+ssize_t WriteResponses(int fd, const Execute::Response &responses, std::size_t offset) {
+    static_assert(MaxIov <= IOV_MAX, "writev could not accept that many segments");
+    Execute::Response::Segment segments[MaxIov];
+    std::size_t count = responses.Gather(offset, segments, MaxIov);
+    if (count == 0) {
+        return 0;
+    }
+
+    struct iovec iov[MaxIov];
+    for (std::size_t i = 0; i < count; i++) {
+        iov[i].iov_base = const_cast<char *>(segments[i].data);
+        iov[i].iov_len = segments[i].size;
+    }
+    return writev(fd, iov, count);
+}
+
+// See Writer.h
+bool WriteAll(int fd, const Execute::Response &responses) {
+    std::size_t written = 0;
+    while (written < responses.Size()) {
+        ssize_t result = WriteResponses(fd, responses, written);
+        if (result > 0) {
+            written += result;
+        } else if (result == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// See Writer.h
+bool WriteOrQueue(int fd, const Execute::Response &responses, Buffer &queue) {
+    std::size_t written = 0;
+    if (queue.Empty()) {
+        ssize_t result = WriteResponses(fd, responses, written);
+        if (result > 0) {
+            written = result;
+        } else if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+        }
+    }
+
+    // Socket is busy, the rest waits for it in the queue
+    Execute::Response::Segment segments[MaxIov];
+    while (written < responses.Size()) {
+        std::size_t count = responses.Gather(written, segments, MaxIov);
+        for (std::size_t i = 0; i < count; i++) {
+            queue.Append(segments[i].data, segments[i].size);
+            written += segments[i].size;
+        }
+    }
+    return true;
+}
+
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,38 @@
+#ifndef AFINA_NETWORK_WRITER_H
+#define AFINA_NETWORK_WRITER_H
+
+#include <cstddef>
+
+#include <sys/types.h>
+
+namespace Afina {
+namespace Execute {
+class Response;
+} // namespace Execute
+namespace Network {
+
+class Buffer;
+
+/**
+ * Writes responses starting at the given offset with a single writev(2) call over their segments, so values read
+ * out of storage go to the socket without being copied into any buffer on the way. Returns result of writev(2)
+ */
+ssize_t WriteResponses(int fd, const Execute::Response &responses, std::size_t offset);
+
+/**
+ * Writes all responses to the blocking descriptor, as many writev(2) calls as it takes. Returns false if
+ * descriptor fails
+ */
+bool WriteAll(int fd, const Execute::Response &responses);
+
+/**
+ * Writes responses to the nonblocking descriptor. They go to the socket directly if nothing is queued in front
+ * of them, whatever socket doesn't accept right away is copied to the queue to be written once it's writable.
+ * Returns false if descriptor fails
+ */
+bool WriteOrQueue(int fd, const Execute::Response &responses, Buffer &queue);
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_WRITER_H
@@ -11,11 +11,18 @@ namespace Coroutine {
 struct Connection;
 
 struct Connection {
-    Connection() : prev(nullptr), next(nullptr), ctx(nullptr), events(0), running(false){};
+    Connection()
+        : prev(nullptr), next(nullptr), ctx(nullptr), socket(-1), events(0), waiting(0), running(false){};
     Connection *prev;
     Connection *next;
     Afina::Coroutine::Engine::context *ctx;
+    int socket;
+
+    // Readiness reported by edge-triggered epoll and not consumed yet
     uint32_t events;
+
+    // Events coroutine is blocked on, zero if it doesn't wait for socket
+    uint32_t waiting;
     std::atomic_bool running;
 };
 } // namespace Coroutine
@@ -4,12 +4,39 @@ namespace Afina {
 namespace Network {
 namespace Coroutine {
 
-static constexpr int EVENT_READ = EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP | EPOLLET;
-static constexpr int EVENT_WRITE = EPOLLOUT | EPOLLRDHUP | EPOLLERR | EPOLLHUP | EPOLLET;
+// Client sockets are registered once for both directions, edge-triggered: kernel reports only changes
+// of readiness, which are accumulated in Connection::events till coroutine runs into EAGAIN
+static constexpr uint32_t EVENT_CLIENT = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+
+// Events that mean socket is broken and nothing is going to happen anymore
+static constexpr uint32_t EVENT_FAILURE = EPOLLERR | EPOLLHUP;
+
+// Server socket is watched by all shards, exclusive wakeup makes kernel to wake only one of them per
+// incoming connection instead of the whole herd
+#ifdef EPOLLEXCLUSIVE
+static constexpr uint32_t EVENT_ACCEPT = EPOLLIN | EPOLLEXCLUSIVE | EPOLLET;
+#else
+static constexpr uint32_t EVENT_ACCEPT = EPOLLIN | EPOLLET;
+#endif
+
+// Client must send something at least that often, otherwise connection gets closed
+static constexpr std::chrono::seconds READ_TIMEOUT(60);
+
+// Time client is given to accept single response
+static constexpr std::chrono::seconds WRITE_TIMEOUT(10);
+
+using Clock = Afina::Coroutine::Engine::Clock;
+
+// See ServerImpl.h
+ServerImpl::Shard::Shard(ServerImpl *server)
+    : engine([this, server] { server->_idle_func(*this); },
+             Afina::Coroutine::Engine::SeparateStackSupported() ? Afina::Coroutine::Engine::StackMode::Separate
+                                                                : Afina::Coroutine::Engine::StackMode::Copy),
+      epoll_fd(-1), conns(nullptr) {}
 
 // See Server.h
 ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
-    : Server(ps, pl), _engine([this] { this->_idle_func(); }) {}
+    : Server(ps, pl), _running(false) {}
 
 // See Server.h
 ServerImpl::~ServerImpl() {}
@@ -55,32 +82,36 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
     }
 
-    // Start IO workers
-    _data_epoll_fd = epoll_create1(0);
-    if (_data_epoll_fd == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
-    }
-
     _event_fd = eventfd(0, EFD_NONBLOCK);
     if (_event_fd == -1) {
         throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
     }
 
-    {
-        std::lock_guard<std::mutex> lock(_m);
-        conns = nullptr;
-    }
+    // Start IO workers, one engine per thread
+    _shards.resize(std::max(n_workers, 1u));
+    for (auto &shard : _shards) {
+        shard.reset(new Shard(this));
+        shard->epoll_fd = epoll_create1(0);
+        if (shard->epoll_fd == -1) {
+            throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+        }
 
-    struct epoll_event event;
-    memset(&event, 0, sizeof(event));
-    event.events = EPOLLIN;
-    event.data.ptr = this;
-    if (epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
-        throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+        // Eventfd is never read, so it is edge-triggered: stop is reported to every shard once rather than by
+        // each epoll_wait till the shard is empty
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = this;
+        if (epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+            throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+        }
     }
 
     _running = true;
-    _thread = std::thread([this] { this->_engine.start_noargs([this] { this->OnRun(); }); });
+    for (auto &shard : _shards) {
+        Shard *ps = shard.get();
+        ps->thread = std::thread([this, ps] { ps->engine.start_noargs([this, ps] { this->OnRun(*ps); }); });
+    }
 }
 
 // See Server.h
@@ -88,18 +119,7 @@ void ServerImpl::Stop() {
     _logger->warn("Stop network service");
     _running = false;
 
-    {
-        std::lock_guard<std::mutex> lock(_m);
-        for (auto connptr = conns; connptr != nullptr; connptr = connptr->next) {
-            connptr->running = false;
-        }
-
-        for (auto sock : sockets) {
-            shutdown(sock, SHUT_RDWR);
-        }
-    }
-
-    // Wakeup threads that are sleep on epoll_wait
+    // Wakeup threads that are sleep on epoll_wait, each of them stops its own connections
     if (eventfd_write(_event_fd, 1)) {
         throw std::runtime_error("Failed to unlock coroutines");
     }
@@ -107,37 +127,34 @@ void ServerImpl::Stop() {
 
 // See Server.h
 void ServerImpl::Join() {
-    if (_thread.joinable()) {
-        _thread.join();
+    for (auto &shard : _shards) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+        close(shard->epoll_fd);
     }
+    _shards.clear();
     close(_server_socket);
+    close(_event_fd);
 }
 
 // See ServerImpl.h
-void ServerImpl::OnRun() {
-    auto cur_rout = _engine.get_cur_routine();
+void ServerImpl::OnRun(Shard &shard) {
     auto newconn = new Connection;
     newconn->events = 0;
     newconn->running = true;
-    newconn->ctx = cur_rout;
-    {
-        std::lock_guard<std::mutex> lock(_m);
-        conns = newconn;
-    }
+    newconn->ctx = shard.engine.get_cur_routine();
+    add_conn_to_list(shard, newconn);
+    _register(shard, _server_socket, EVENT_ACCEPT, newconn);
     while (_running) {
         struct sockaddr in_addr;
         socklen_t in_len;
         in_len = sizeof(in_addr);
-        int infd = _accept(_server_socket, &in_addr, &in_len, newconn);
+        int infd = _accept(shard, _server_socket, &in_addr, &in_len, newconn, Clock::time_point::max());
         if (infd == -1) {
             continue;
         }
 
-        {
-            std::lock_guard<std::mutex> lock(_m);
-            sockets.push_front(infd);
-        }
-
         // Print host and service info.
         char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
         int retval =
@@ -146,198 +163,218 @@ void ServerImpl::OnRun() {
             _logger->info("Accepted connection on descriptor {} (host={}, port={})\n", infd, hbuf, sbuf);
         }
 
-        _engine.run_noargs([this, infd]() { this->Worker(infd); });
+        Shard *ps = &shard;
+        shard.engine.run_noargs([this, ps, infd]() { this->Worker(*ps, infd); });
     }
-    del_conn_from_list(newconn);
+
+    // Server socket is open till Join, while other coroutines of the shard could still be finishing
+    _unregister(shard, _server_socket);
+    del_conn_from_list(shard, newconn);
 }
 
-void ServerImpl::Worker(int client_socket) {
-    std::size_t arg_remains;
-    Protocol::Parser parser;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+void ServerImpl::Worker(Shard &shard, int client_socket) {
+    Protocol::Session session(pStorage, pLogging->select("execute"));
+    Buffer client_buffer;
+    Execute::Response response;
     auto conn = new Connection;
     conn->events = 0;
     conn->running = true;
-    conn->ctx = _engine.get_cur_routine();
-    {
-        std::lock_guard<std::mutex> lock(_m);
-        conn->next = conns;
-        conns = conn;
-        if (conn->next != nullptr) {
-            conn->next->prev = conn;
-        }
-    }
+    conn->ctx = shard.engine.get_cur_routine();
+    conn->socket = client_socket;
+    add_conn_to_list(shard, conn);
     try {
+        _register(shard, client_socket, EVENT_CLIENT, conn);
+
         int readed_bytes = -1;
-        char client_buffer[4096];
-        while (_running && (readed_bytes = _read(client_socket, client_buffer, sizeof(client_buffer), conn)) > 0) {
+        bool write_failed = false;
+        while (_running && (readed_bytes = _read(shard, client_socket, client_buffer, session, response, conn)) > 0) {
             _logger->debug("Got {} bytes from socket", readed_bytes);
 
-            // Single block of data readed from the socket could trigger inside actions a multiple times,
-            // for example:
-            // - read#0: [<command1 start>]
-            // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-            while (readed_bytes > 0) {
-                _logger->debug("Process {} bytes", readed_bytes);
-                // There is no command yet
-                if (!command_to_execute) {
-                    std::size_t parsed = 0;
-                    if (parser.Parse(client_buffer, readed_bytes, parsed)) {
-                        // There is no command to be launched, continue to parse input stream
-                        // Here we are, current chunk finished some command, process it
-                        _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
-                        if (arg_remains > 0) {
-                            arg_remains += 2;
-                        }
-                    }
-
-                    // Parsed might fails to consume any bytes from input stream. In real life that could happens,
-                    // for example, because we are working with UTF-16 chars and only 1 byte left in stream
-                    if (parsed == 0) {
-                        break;
-                    } else {
-                        std::memmove(client_buffer, client_buffer + parsed, readed_bytes - parsed);
-                        readed_bytes -= parsed;
-                    }
+            // Send responses of all commands found in the read at once
+            if (!response.Empty()) {
+                session.BeginWrite();
+                ssize_t written = _write(shard, client_socket, response, conn);
+                session.EndWrite();
+                if (written == -1) {
+                    write_failed = true;
+                    break;
                 }
+                response.Clear();
+            }
 
-                // There is command, but we still wait for argument to arrive...
-                if (command_to_execute && arg_remains > 0) {
-                    _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
-                    // There is some parsed command, and now we are reading argument
-                    std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
-                    argument_for_command.append(client_buffer, to_read);
-
-                    std::memmove(client_buffer, client_buffer + to_read, readed_bytes - to_read);
-                    arg_remains -= to_read;
-                    readed_bytes -= to_read;
-                }
-                // Thre is command & argument - RUN!
-                if (command_to_execute && arg_remains == 0) {
-                    _logger->debug("Start command execution");
-
-                    std::string result;
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
-                    // Send response
-                    result += "\r\n";
-                    if (_write(client_socket, result.data(), result.size(), conn) == -1) {
-                        break;
-                    }
-
-                    // Prepare for the next command
-                    command_to_execute.reset();
-                    argument_for_command.resize(0);
-                    parser.Reset();
-                }
-            } // while (readed_bytes)
+            if (session.Closed()) {
+                break;
+            }
         }
-        if (readed_bytes == 0) {
+
+        // Server stop interrupts IO of every connection, errno tells nothing then
+        if (!session.Error().empty()) {
+            _logger->error("Failed to process connection on descriptor {}: {}", client_socket, session.Error());
+        } else if (readed_bytes == 0 || session.Closed()) {
             _logger->debug("Connection closed");
+        } else if (!_running || !conn->running) {
+            _logger->debug("Connection closed on server stop");
+        } else if (write_failed) {
+            _logger->debug("Client doesn't accept responses: {}", strerror(errno));
         } else {
             throw std::runtime_error(std::string(strerror(errno)));
         }
     } catch (std::runtime_error &ex) {
         _logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
     }
-    del_conn_from_list(conn);
-    {
-        std::lock_guard<std::mutex> lock(_m);
-        sockets.remove(client_socket);
-    }
+    del_conn_from_list(shard, conn);
     close(client_socket);
 }
 
-void ServerImpl::_idle_func() {
+void ServerImpl::_idle_func(Shard &shard) {
     const int maxevents = 64; // MAGIC NUMBER
     struct epoll_event events[maxevents];
     memset(events, 0, sizeof(events[0]) * maxevents);
     int n_events = -1;
-    while (_engine.all_blocked()) {
-        n_events = epoll_wait(_data_epoll_fd, events, maxevents, -1);
+    while (shard.engine.all_blocked()) {
+        n_events = epoll_wait(shard.epoll_fd, events, maxevents, shard.engine.NextTimeout());
 
         if (n_events == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
             throw std::runtime_error("Error while calling epoll_wait in _idle_func");
         }
         for (int i = 0; i < n_events; ++i) {
             if (events[i].data.ptr == this) { // special value, which means a signal from event_fd, server is stopping
-                _engine.WakeAll();            // all the coroutines should wake up and get ready to stop
+                for (auto connptr = shard.conns; connptr != nullptr; connptr = connptr->next) {
+                    connptr->running = false;
+                    if (connptr->socket != -1) {
+                        shutdown(connptr->socket, SHUT_RDWR);
+                    }
+                }
+                shard.engine.WakeAll(); // all the coroutines should wake up and get ready to stop
                 continue;
             }
             auto cur_conn = static_cast<Connection *>(events[i].data.ptr);
-            auto cur_rout = static_cast<Afina::Coroutine::Engine::context *>(cur_conn->ctx);
-
-            cur_conn->events = events[i].events;
-            _engine.Wake(cur_rout);
+            cur_conn->events |= events[i].events;
+            if (cur_conn->events & cur_conn->waiting) {
+                cur_conn->waiting = 0;
+                shard.engine.Wake(cur_conn->ctx);
+            }
         }
+
+        // Deadlines are checked after IO, so that coroutine which got its event just in time proceeds
+        shard.engine.WakeExpired();
     }
-    _engine.yield();
+    shard.engine.yield();
 }
 
-void ServerImpl::_block_on_epoll(int fd, uint32_t events, Connection *cur_conn) {
-    struct epoll_event struct_events;
-    memset(&struct_events, 0, sizeof(struct_events));
-    struct_events.events = events;
-    struct_events.data.ptr = cur_conn;
-    if (epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, fd, &struct_events)) {
-        throw std::runtime_error("Error while calling epoll_ctl in _block_on_epoll");
+void ServerImpl::_register(Shard &shard, int fd, uint32_t events, Connection *conn) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = conn;
+    if (epoll_ctl(shard.epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+        throw std::runtime_error("Error while calling epoll_ctl in _register: " + std::string(strerror(errno)));
+    }
+}
+
+void ServerImpl::_unregister(Shard &shard, int fd) {
+    if (epoll_ctl(shard.epoll_fd, EPOLL_CTL_DEL, fd, nullptr)) {
+        throw std::runtime_error("Error while calling epoll_ctl in _unregister: " + std::string(strerror(errno)));
     }
-    cur_conn->events = 0;
-    _engine.Block();
-    if (epoll_ctl(_data_epoll_fd, EPOLL_CTL_DEL, fd, &struct_events)) {
-        throw std::runtime_error("Error while calling epoll_ctl in _block_on_epoll");
+}
+
+bool ServerImpl::_wait_ready(Shard &shard, Connection *conn, uint32_t events, Clock::time_point deadline) {
+    while (conn->running && !(conn->events & events)) {
+        conn->waiting = events;
+        bool in_time = true;
+        if (deadline == Clock::time_point::max()) {
+            shard.engine.Block();
+        } else {
+            in_time = shard.engine.BlockUntil(deadline);
+        }
+        conn->waiting = 0;
+        if (!in_time) {
+            return false;
+        }
     }
+    return true;
 }
 
-ssize_t ServerImpl::_read(int fd, void *buf, size_t count, Connection *conn) {
+ssize_t ServerImpl::_read(Shard &shard, int fd, Buffer &buf, Protocol::Session &session, Execute::Response &out,
+                          Connection *conn) {
+    Clock::time_point deadline = Clock::now() + READ_TIMEOUT;
     while (conn->running) {
-        ssize_t bytes_read = read(fd, buf, count);
-        if (bytes_read > 0) {
+        ssize_t bytes_read = ReadRequests(fd, buf, session, out);
+        if (bytes_read >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
             return bytes_read;
-        } else {
-            _block_on_epoll(fd, EVENT_READ, conn);
-            uint32_t events = conn->events;
-            if ((events & EPOLLRDHUP) || (events & EPOLLERR) || (events & EPOLLHUP)) {
-                return read(fd, buf, count);
-            }
+        }
+
+        // Socket is drained, the next edge is going to tell when there is more
+        conn->events &= ~EPOLLIN;
+        if (!_wait_ready(shard, conn, EPOLLIN | EPOLLRDHUP | EVENT_FAILURE, deadline)) {
+            errno = ETIMEDOUT;
+            return -1;
         }
     }
     return -1;
 }
 
-ssize_t ServerImpl::_write(int fd, const void *buf, size_t count, Connection *conn) {
-    ssize_t written = 0;
+ssize_t ServerImpl::_write(Shard &shard, int fd, const Execute::Response &responses, Connection *conn) {
+    Clock::time_point deadline = Clock::now() + WRITE_TIMEOUT;
+    size_t count = responses.Size();
+    size_t written = 0;
     while (conn->running) {
-        written += write(fd, static_cast<const void *>(static_cast<const char *>(buf) + written), count - written);
-        if (written < count) {
-            _block_on_epoll(fd, EVENT_WRITE, conn);
-            uint32_t events = conn->events;
-            if ((events & EPOLLERR) || (events & EPOLLHUP)) {
+        ssize_t n = WriteResponses(fd, responses, written);
+        if (n > 0) {
+            written += n;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return -1;
+        }
+
+        if (written == count) {
+            return written;
+        }
+        if (n <= 0) {
+            // Send buffer is full, wait till peer consumes something
+            conn->events &= ~EPOLLOUT;
+            if (!_wait_ready(shard, conn, EPOLLOUT | EVENT_FAILURE, deadline)) {
+                errno = ETIMEDOUT;
+                return -1;
+            }
+            if (conn->events & EVENT_FAILURE) {
                 return -1;
             }
-        } else {
-            return written;
         }
     }
     return -1;
 }
 
-int ServerImpl::_accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen, Connection *conn) {
+int ServerImpl::_accept(Shard &shard, int sockfd, struct sockaddr *addr, socklen_t *addrlen, Connection *conn,
+                        Clock::time_point deadline) {
     while (conn->running) {
         int fd = accept4(sockfd, addr, addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
-        if (fd == -1) {
-            _block_on_epoll(sockfd, EVENT_READ, conn);
-        } else {
+        if (fd != -1) {
             return fd;
         }
+
+        // Backlog is empty, wait for the next connection to arrive
+        conn->events &= ~EPOLLIN;
+        if (!_wait_ready(shard, conn, EPOLLIN, deadline)) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
     }
     return -1;
 }
 
-void ServerImpl::del_conn_from_list(Connection *cur_conn) {
-    std::lock_guard<std::mutex> lg(_m);
+void ServerImpl::add_conn_to_list(Shard &shard, Connection *cur_conn) {
+    cur_conn->prev = nullptr;
+    cur_conn->next = shard.conns;
+    shard.conns = cur_conn;
+    if (cur_conn->next != nullptr) {
+        cur_conn->next->prev = cur_conn;
+    }
+}
 
+void ServerImpl::del_conn_from_list(Shard &shard, Connection *cur_conn) {
     if (cur_conn->prev != nullptr) {
         cur_conn->prev->next = cur_conn->next;
     }
@@ -346,8 +383,8 @@ void ServerImpl::del_conn_from_list(Connection *cur_conn) {
         cur_conn->next->prev = cur_conn->prev;
     }
 
-    if (conns == cur_conn) {
-        conns = cur_conn->next;
+    if (shard.conns == cur_conn) {
+        shard.conns = cur_conn->next;
     }
     cur_conn->prev = cur_conn->next = nullptr;
     delete cur_conn;
@@ -355,4 +392,4 @@ void ServerImpl::del_conn_from_list(Connection *cur_conn) {
 
 } // namespace Coroutine
 } // namespace Network
-} // namespace Afina
\ No newline at end of file
+} // namespace Afina
@@ -12,14 +12,15 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <functional>
 #include <iostream>
-#include <list>
-#include <mutex>
+#include <memory>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 
 #include <afina/Storage.h>
 #include <afina/logging/Service.h>
@@ -29,8 +30,12 @@
 #include "Utils.h"
 #include <afina/coroutine/Engine.h>
 #include <afina/execute/Command.h>
+#include <afina/execute/Response.h>
 #include <afina/network/Server.h>
-#include <protocol/Parser.h>
+#include <network/Buffer.h>
+#include <network/Reader.h>
+#include <network/Writer.h>
+#include <protocol/Session.h>
 
 namespace spdlog {
 class logger;
@@ -59,56 +64,78 @@ public:
     void Join() override;
 
 protected:
-    void OnRun();
+    /**
+     * Everything single network thread works with. Each thread runs its own coroutine engine over its own
+     * epoll instance, accepts connections from the shared server socket and serves them till the end, so
+     * shard state is never touched by other threads
+     */
+    struct Shard {
+        explicit Shard(ServerImpl *server);
+
+        // Coroutine engine
+        Afina::Coroutine::Engine engine;
+
+        // Network thread
+        std::thread thread;
+
+        // EPOLL instance coroutines of this shard wait on
+        int epoll_fd;
+
+        // List of connections
+        Connection *conns;
+    };
+
+    void OnRun(Shard &shard);
 
 private:
     // logger to use
     std::shared_ptr<spdlog::logger> _logger;
 
-    // Coroutine engine
-    Afina::Coroutine::Engine _engine;
-
-    // Network thread
-    std::thread _thread;
+    // Network threads
+    std::vector<std::unique_ptr<Shard>> _shards;
 
-    std::mutex _m;
-    // List of connections
-    Connection *conns;
-
-    // Socket to accept new connection on, shared between acceptors
+    // Socket to accept new connection on, shared between shards
     int _server_socket;
 
-    // EPOLL instance shared between workers
-    int _data_epoll_fd;
-
-    // Curstom event "device" used to wakeup workers
+    // Curstom event "device" used to wakeup shards
     int _event_fd;
 
     // Whether network is running
-    bool _running = false;
+    std::atomic<bool> _running;
 
 private:
-    // Coroutine-aware variants of standard functions
-    ssize_t _read(int fd, void *buf, size_t count, Connection *conn);
-    ssize_t _write(int fd, const void *buf, size_t count, Connection *conn);
-    int _accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen, Connection *conn);
+    // Coroutine-aware variants of standard functions. Read and write give up with ETIMEDOUT if peer
+    // doesn't make any progress for too long, accept waits till the given deadline. Read feeds the
+    // data to the session, see ReadRequests
+    ssize_t _read(Shard &shard, int fd, Buffer &buf, Protocol::Session &session, Execute::Response &out,
+                  Connection *conn);
+    ssize_t _write(Shard &shard, int fd, const Execute::Response &responses, Connection *conn);
+    int _accept(Shard &shard, int sockfd, struct sockaddr *addr, socklen_t *addrlen, Connection *conn,
+                Afina::Coroutine::Engine::Clock::time_point deadline);
 
     // Idle func for coroutine engine
-    void _idle_func();
+    void _idle_func(Shard &shard);
 
-    // Block on epoll: effectively, file a request to epoll
-    // and give up current coroutine execution
-    // epoll_wait will be called by _idle_func when the time
-    // is right (that is, there is no coroutine to be
-    // executed)
-    void _block_on_epoll(int fd, uint32_t events, Connection *conn);
+    // Adds descriptor to the shard epoll for the whole connection lifetime, closing descriptor removes it.
+    // Events get accumulated in the connection by _idle_func
+    void _register(Shard &shard, int fd, uint32_t events, Connection *conn);
 
-    // Function to handle client connection
-    void Worker(int client_socket);
+    // Removes descriptor which stays open after its connection is gone, such as server socket, from the shard
+    // epoll, so that events don't get accumulated in the freed connection
+    void _unregister(Shard &shard, int fd);
 
-    std::list<int> sockets;
+    // Give up current coroutine execution till any of the given events is reported for the
+    // connection. epoll_wait will be called by _idle_func when the time is right (that is, there is no
+    // coroutine to be executed). Returns false if deadline has passed before any event, time_point::max()
+    // means no deadline
+    bool _wait_ready(Shard &shard, Connection *conn, uint32_t events,
+                     Afina::Coroutine::Engine::Clock::time_point deadline);
+
+    // Function to handle client connection
+    void Worker(Shard &shard, int client_socket);
 
-    void del_conn_from_list(Connection *cur_conn);
+    void add_conn_to_list(Shard &shard, Connection *cur_conn);
+    void del_conn_from_list(Shard &shard, Connection *cur_conn);
 };
 
 } // namespace Coroutine
@@ -23,9 +23,13 @@
 
 #include <afina/Storage.h>
 #include <afina/execute/Command.h>
+#include <afina/execute/Response.h>
 #include <afina/logging/Service.h>
 
-#include "protocol/Parser.h"
+#include "network/Buffer.h"
+#include "network/Reader.h"
+#include "network/Writer.h"
+#include "protocol/Session.h"
 
 namespace Afina {
 namespace Network {
@@ -180,88 +184,36 @@ void ServerImpl::OnRun() {
 
 void ServerImpl::OnWork(int client_socket) {
     // Here is connection state
-    // - parser: parse state of the stream
-    // - command_to_execute: last command parsed out of stream
-    // - arg_remains: how many bytes to read from stream to get command argument
-    // - argument_for_command: buffer stores argument
-    std::size_t arg_remains;
-    Protocol::Parser parser;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    // - session: protocol state of the stream, commands which are not complete yet
+    // - client_buffer: bytes read from the socket but not processed yet
+    // - response: responses of the commands completed by the last read
+    Protocol::Session session(pStorage, pLogging->select("execute"));
+    Buffer client_buffer;
+    Execute::Response response;
     try {
         int readed_bytes = -1;
-        char client_buffer[4096];
-        while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
+        while ((readed_bytes = ReadRequests(client_socket, client_buffer, session, response)) > 0) {
             _logger->debug("Got {} bytes from socket", readed_bytes);
 
-            // Single block of data readed from the socket could trigger inside actions a multiple times,
-            // for example:
-            // - read#0: [<command1 start>]
-            // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-            while (readed_bytes > 0) {
-                _logger->debug("Process {} bytes", readed_bytes);
-                // There is no command yet
-                if (!command_to_execute) {
-                    std::size_t parsed = 0;
-                    if (parser.Parse(client_buffer, readed_bytes, parsed)) {
-                        // There is no command to be launched, continue to parse input stream
-                        // Here we are, current chunk finished some command, process it
-                        _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
-                        if (arg_remains > 0) {
-                            arg_remains += 2;
-                        }
-                    }
-
-                    // Parsed might fails to consume any bytes from input stream. In real life that could happens,
-                    // for example, because we are working with UTF-16 chars and only 1 byte left in stream
-                    if (parsed == 0) {
-                        break;
-                    } else {
-                        std::memmove(client_buffer, client_buffer + parsed, readed_bytes - parsed);
-                        readed_bytes -= parsed;
-                    }
-                }
-
-                // There is command, but we still wait for argument to arrive...
-                if (command_to_execute && arg_remains > 0) {
-                    _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
-                    // There is some parsed command, and now we are reading argument
-                    std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
-                    argument_for_command.append(client_buffer, to_read);
-
-                    std::memmove(client_buffer, client_buffer + to_read, readed_bytes - to_read);
-                    arg_remains -= to_read;
-                    readed_bytes -= to_read;
+            // Send responses of all commands found in the read at once
+            if (!response.Empty()) {
+                session.BeginWrite();
+                bool written = WriteAll(client_socket, response);
+                session.EndWrite();
+                if (!written) {
+                    throw std::runtime_error("Failed to send response");
                 }
+                response.Clear();
+            }
 
-                // Thre is command & argument - RUN!
-                if (command_to_execute && arg_remains == 0) {
-                    _logger->debug("Start command execution");
-
-                    std::string result;
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
-
-                    // Send response
-                    result += "\r\n";
-                    if (send(client_socket, result.data(), result.size(), 0) <= 0) {
-                        throw std::runtime_error("Failed to send response");
-                    }
-
-                    // Prepare for the next command
-                    // _logger->debug("{} bytes left, resetting", readed_bytes);
-                    command_to_execute.reset();
-                    argument_for_command.resize(0);
-                    parser.Reset();
-                    // _logger->debug("{} bytes left after reset", readed_bytes);
-                }
-            } // while (readed_bytes)
-            // _logger->debug("Got some  bytes ({}) from socket left", readed_bytes);
+            if (session.Closed()) {
+                break;
+            }
         }
 
-        // _logger->debug("Got all commands, {} bytes left", readed_bytes);
-
-        if (readed_bytes == 0) {
+        if (!session.Error().empty()) {
+            _logger->error("Failed to process connection on descriptor {}: {}", client_socket, session.Error());
+        } else if (readed_bytes == 0 || session.Closed()) {
             _logger->debug("Connection closed");
         } else if (readed_bytes == -1 && errno == EAGAIN) {
             // TIMEOUT
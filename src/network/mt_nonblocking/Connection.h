@@ -8,9 +8,11 @@
 
 #include <sys/epoll.h>
 
-#include "protocol/Parser.h"
+#include "network/Buffer.h"
+#include "protocol/Session.h"
 #include <afina/Storage.h>
 #include <afina/execute/Command.h>
+#include <afina/execute/Response.h>
 
 namespace Afina {
 namespace Network {
@@ -18,7 +20,8 @@ namespace MTnonblock {
 
 class Connection {
 public:
-    Connection(int s, std::shared_ptr<Afina::Storage> store) : _socket(s) {
+    Connection(int s, std::shared_ptr<Afina::Storage> store, std::shared_ptr<spdlog::logger> tracer)
+        : session(store, tracer), _socket(s) {
         std::memset(&_event, 0, sizeof(struct epoll_event));
         _event.data.ptr = this;
         pStorage = store;
@@ -37,28 +40,29 @@ protected:
     void DoRead();
     void DoWrite();
 
+    // Writes queued responses, expects _alive_mutex to be held
+    void Flush();
+
+    // Returns memory used to process input and output back to the pools of the current worker, once
+    // connection has nothing to process it costs only sizeof(Connection)
+    void ReleaseBuffers();
+
 private:
     friend class Worker;
     friend class ServerImpl;
 
     std::shared_ptr<Afina::Storage> pStorage;
 
-    Protocol::Parser parser;
-    std::size_t arg_remains;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    // Protocol state of the stream
+    Protocol::Session session;
 
     bool _alive;
     std::mutex _alive_mutex;
     int _socket;
     struct epoll_event _event;
 
-    std::size_t _read_queue_size;
-    char _read_buffer[256];
-    std::size_t _sent_last;
-
-    std::vector<std::string> _answers;
-    std::mutex _answ_mutex;
+    Buffer _read_buffer;
+    Buffer _write_buffer;
 };
 
 } // namespace MTnonblock
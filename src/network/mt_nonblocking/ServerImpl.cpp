@@ -98,7 +98,7 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
     _workers.reserve(n_workers);
     _logger->debug("Starting workers: {}", n_workers);
     for (int i = 0; i < n_workers; i++) {
-        _workers.emplace_back(pStorage, pLogging, _connections);
+        _workers.emplace_back(pStorage, pLogging, this);
         _workers.back().Start(_data_epoll_fd);
     }
 
@@ -118,11 +118,13 @@ void ServerImpl::Stop() {
         w.Stop();
     }
 
-    for (auto c : _connections) {
-        close(c->_socket);
-        delete c; // <- Is he smiling? Is he crying?
+    // Make connections drain, workers pick them up and release
+    {
+        std::lock_guard<std::mutex> lock(_connections_mutex);
+        for (auto c : _connections) {
+            shutdown(c->_socket, SHUT_RDWR);
+        }
     }
-    _connections.clear();
 
     // Wakeup threads that are sleep on epoll_wait
     if (eventfd_write(_event_fd, 1)) {
@@ -139,6 +141,23 @@ void ServerImpl::Join() {
     for (auto &w : _workers) {
         w.Join();
     }
+
+    // No one is serving connections anymore, release what is left
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+    for (auto c : _connections) {
+        close(c->_socket);
+        _connection_pool.Destroy(c);
+    }
+    _connections.clear();
+}
+
+// See ServerImpl.h
+void ServerImpl::OnCloseConnection(Connection *pc) {
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+    if (_connections.erase(pc) > 0) {
+        close(pc->_socket);
+        _connection_pool.Destroy(pc);
+    }
 }
 
 // See ServerImpl.h
@@ -202,11 +221,12 @@ void ServerImpl::OnRun() {
                 }
 
                 // Register the new FD to be monitored by epoll.
-                Connection *pc = new Connection(infd, pStorage);
-                if (pc == nullptr) {
-                    throw std::runtime_error("Failed to allocate connection");
+                Connection *pc;
+                {
+                    std::lock_guard<std::mutex> lock(_connections_mutex);
+                    pc = _connection_pool.Create(infd, pStorage, pLogging->select("execute"));
+                    _connections.insert(pc);
                 }
-                _connections.insert(pc);
 
                 // Register connection in worker's epoll
                 pc->Start();
@@ -215,8 +235,7 @@ void ServerImpl::OnRun() {
                     if (epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
                         _logger->error("OnError {}\n", strerror(errno));
                         pc->OnError();
-                        delete pc;
-                        _connections.erase(pc);
+                        OnCloseConnection(pc);
                     }
                 }
             }
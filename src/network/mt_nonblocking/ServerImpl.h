@@ -1,13 +1,15 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 
+#include <mutex>
+#include <set>
 #include <thread>
 #include <vector>
-#include <set>
 
 #include <afina/network/Server.h>
 
 #include "Connection.h"
+#include "network/ObjectPool.h"
 
 namespace spdlog {
 class logger;
@@ -42,6 +44,12 @@ protected:
     void OnRun();
     void OnNewConnection();
 
+    /**
+     * Closes connection socket and returns connection memory back to the pool, called by worker once
+     * connection is dead
+     */
+    void OnCloseConnection(Connection *pc);
+
 private:
     // logger to use
     std::shared_ptr<spdlog::logger> _logger;
@@ -66,7 +74,17 @@ private:
 
     // threads serving read/write requests
     std::vector<Worker> _workers;
-    std::set<Connection * > _connections;
+
+    // Guards connections set and pool, acceptors add connections while workers remove them
+    std::mutex _connections_mutex;
+
+    // All connections currently registered in the workers epoll
+    std::set<Connection *> _connections;
+
+    // Memory for connections
+    ObjectPool<Connection> _connection_pool;
+
+    friend class Worker;
 };
 
 } // namespace MTnonblock
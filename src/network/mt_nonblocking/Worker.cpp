@@ -15,6 +15,7 @@
 #include <afina/logging/Service.h>
 
 #include "Connection.h"
+#include "ServerImpl.h"
 #include "Utils.h"
 
 namespace Afina {
@@ -22,8 +23,8 @@ namespace Network {
 namespace MTnonblock {
 
 // See Worker.h
-Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, std::set<Connection *> &cons)
-    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1), _connections(cons) {
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, ServerImpl *server)
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1), _server(server) {
     // TODO: implementation here
 }
 
@@ -34,7 +35,7 @@ Worker::~Worker() {
 }
 
 // See Worker.h
-Worker::Worker(Worker &&other) : _connections(other._connections) { *this = std::move(other); }
+Worker::Worker(Worker &&other) { *this = std::move(other); }
 
 // See Worker.h
 Worker &Worker::operator=(Worker &&other) {
@@ -43,6 +44,7 @@ Worker &Worker::operator=(Worker &&other) {
     _logger = std::move(other._logger);
     _thread = std::move(other._thread);
     _epoll_fd = other._epoll_fd;
+    _server = other._server;
 
     other._epoll_fd = -1;
     return *this;
@@ -113,8 +115,7 @@ void Worker::OnRun() {
                 pconn->_event.events |= EPOLLONESHOT;
                 if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event)) {
                     pconn->OnError();
-                    _connections.erase(pconn);
-                    // delete pconn;
+                    _server->OnCloseConnection(pconn);
                 }
             }
             // Or delete closed one
@@ -122,8 +123,7 @@ void Worker::OnRun() {
                 if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
                     std::cerr << "Failed to delete connection!" << std::endl;
                 }
-                _connections.erase(pconn);
-                // delete pconn;
+                _server->OnCloseConnection(pconn);
             }
         }
         // TODO: Select timeout...
@@ -4,7 +4,6 @@
 #include <atomic>
 #include <memory>
 #include <thread>
-#include <set>
 
 #include "Connection.h"
 
@@ -23,6 +22,9 @@ class Service;
 namespace Network {
 namespace MTnonblock {
 
+// Forward declaration, see ServerImpl.h
+class ServerImpl;
+
 /**
  * # Thread running epoll
  * On Start spaws background thread that is doing epoll on the given server
@@ -30,7 +32,7 @@ namespace MTnonblock {
  */
 class Worker {
 public:
-    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, std::set<Connection *> &cons);
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, ServerImpl *server);
     ~Worker();
 
     Worker(Worker &&);
@@ -85,7 +87,8 @@ private:
     // EPOLL descriptor using for events processing
     int _epoll_fd;
 
-    std::set<Connection *> _connections;
+    // Server owning connections, dead ones are returned there
+    ServerImpl *_server;
 };
 
 } // namespace MTnonblock
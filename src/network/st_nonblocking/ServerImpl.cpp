@@ -165,7 +165,7 @@ void ServerImpl::OnRun() {
                 close(pc->_socket);
                 pc->OnClose();
 
-                delete pc;
+                _connection_pool.Destroy(pc);
             } else if (pc->_event.events != old_mask) {
                 if (epoll_ctl(epoll_descr, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
                     _logger->error("Failed to change connection event mask");
@@ -173,7 +173,7 @@ void ServerImpl::OnRun() {
                     close(pc->_socket);
                     pc->OnClose();
 
-                    delete pc;
+                    _connection_pool.Destroy(pc);
                 }
             }
         }
@@ -207,17 +207,14 @@ void ServerImpl::OnNewConnection(int epoll_descr) {
         }
 
         // Register the new FD to be monitored by epoll.
-        Connection *pc = new Connection(infd, pStorage);
-        if (pc == nullptr) {
-            throw std::runtime_error("Failed to allocate connection");
-        }
+        Connection *pc = _connection_pool.Create(infd, pStorage, pLogging->select("execute"));
 
         // Register connection in worker's epoll
         pc->Start();
         if (pc->isAlive()) {
             if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
                 pc->OnError();
-                delete pc;
+                _connection_pool.Destroy(pc);
             }
         }
     }
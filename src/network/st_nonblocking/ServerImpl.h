@@ -6,6 +6,9 @@
 
 #include <afina/network/Server.h>
 
+#include "Connection.h"
+#include "network/ObjectPool.h"
+
 namespace spdlog {
 class logger;
 }
@@ -14,9 +17,6 @@ namespace Afina {
 namespace Network {
 namespace STnonblock {
 
-// Forward declaration, see Worker.h
-class Worker;
-
 /**
  * # Network resource manager implementation
  * Epoll based server
@@ -56,6 +56,9 @@ private:
 
     // IO thread
     std::thread _work_thread;
+
+    // Memory for connections, accessed from IO thread only
+    ObjectPool<Connection> _connection_pool;
 };
 
 } // namespace STnonblock
@@ -0,0 +1,471 @@
+#include "BinaryParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <afina/execute/Request.h>
+#include <afina/execute/Response.h>
+
+namespace Afina {
+namespace Protocol {
+
+constexpr uint8_t BinaryParser::RequestMagic;
+constexpr uint8_t BinaryParser::ResponseMagic;
+constexpr std::size_t BinaryParser::HeaderSize;
+
+namespace {
+
+// Longest key memcached agrees to work with
+constexpr std::size_t MaxKeySize = 250;
+
+// All numbers on the wire are in network byte order
+inline uint16_t load16(const char *p) {
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return uint16_t(u[0]) << 8 | uint16_t(u[1]);
+}
+
+inline uint32_t load32(const char *p) {
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return uint32_t(u[0]) << 24 | uint32_t(u[1]) << 16 | uint32_t(u[2]) << 8 | uint32_t(u[3]);
+}
+
+inline uint64_t load64(const char *p) { return uint64_t(load32(p)) << 32 | load32(p + 4); }
+
+inline void store16(char *p, uint16_t v) {
+    p[0] = char(v >> 8);
+    p[1] = char(v);
+}
+
+inline void store32(char *p, uint32_t v) {
+    p[0] = char(v >> 24);
+    p[1] = char(v >> 16);
+    p[2] = char(v >> 8);
+    p[3] = char(v);
+}
+
+inline void store64(char *p, uint64_t v) {
+    store32(p, uint32_t(v >> 32));
+    store32(p + 4, uint32_t(v));
+}
+
+// Counter commands don't create missing item if expiration is all one-bits
+constexpr uint32_t NoInitial = 0xffffffff;
+
+// Human readable message sent along with the error status
+const char *message(BinaryParser::Status status) {
+    switch (status) {
+    case BinaryParser::KeyNotFound:
+        return "Not found";
+    case BinaryParser::KeyExists:
+        return "Data exists for key.";
+    case BinaryParser::ValueTooLarge:
+        return "Too large.";
+    case BinaryParser::InvalidArguments:
+        return "Invalid arguments";
+    case BinaryParser::ItemNotStored:
+        return "Not stored.";
+    case BinaryParser::NonNumeric:
+        return "Non-numeric server-side value for incr or decr";
+    case BinaryParser::UnknownCommand:
+        return "Unknown command";
+    case BinaryParser::OutOfMemory:
+        return "Out of memory";
+    default:
+        return "";
+    }
+}
+
+} // namespace
+
+// See BinaryParser.h
+bool BinaryParser::Parse(const char *input, const size_t size, size_t &parsed) {
+    parsed = 0;
+    if (_complete) {
+        return true;
+    }
+
+    if (!_header_ready) {
+        std::size_t to_read = std::min(HeaderSize - _head.size(), size);
+        _head.append(input, to_read);
+        parsed += to_read;
+        if (_head.size() < HeaderSize) {
+            return false;
+        }
+
+        const char *header = _head.data();
+        if (uint8_t(header[0]) != RequestMagic) {
+            throw std::runtime_error("Invalid request magic");
+        }
+
+        _opcode = uint8_t(header[1]);
+        _key_size = load16(header + 2);
+        _extras_size = uint8_t(header[4]);
+        _body_size = load32(header + 8);
+        _opaque = load32(header + 12);
+        _cas = load64(header + 16);
+        if (_body_size < std::size_t(_extras_size) + _key_size) {
+            throw std::runtime_error("Request body is shorter than its extras and key");
+        }
+        if (header[5] != 0) {
+            _status = InvalidArguments;
+        }
+
+        // Quiet commands are the same as regular ones except for the response
+        _quiet = true;
+        switch (_opcode) {
+        case GetQ:
+            _base = Get;
+            break;
+        case GetKQ:
+            _base = GetK;
+            break;
+        case SetQ:
+        case AddQ:
+        case ReplaceQ:
+        case DeleteQ:
+        case IncrementQ:
+        case DecrementQ:
+        case QuitQ:
+        case FlushQ:
+            _base = _opcode - SetQ + Set;
+            break;
+        case AppendQ:
+        case PrependQ:
+            _base = _opcode - AppendQ + Append;
+            break;
+        default:
+            _base = _opcode;
+            _quiet = false;
+        }
+        _header_ready = true;
+    }
+
+    std::size_t head_size = HeaderSize + _extras_size + _key_size;
+    std::size_t to_read = std::min(head_size - _head.size(), size - parsed);
+    _head.append(input + parsed, to_read);
+    parsed += to_read;
+    if (_head.size() < head_size) {
+        return false;
+    }
+
+    _validate();
+    _complete = true;
+    return true;
+}
+
+// See BinaryParser.h
+bool BinaryParser::Build(Execute::Request &request, size_t &body_size) const {
+    request.Reset();
+    if (!_complete) {
+        return false;
+    }
+
+    body_size = _body_size - _extras_size - _key_size;
+    if (_status != Success) {
+        return true;
+    }
+
+    const char *extras = _head.data() + HeaderSize;
+    switch (_base) {
+    case Get:
+    case GetK:
+        // Binary responses always carry version of the item
+        request.kind = Execute::Request::Kind::Gets;
+        break;
+    case Set:
+    case Replace:
+    case Add:
+        if (_cas != 0) {
+            request.kind = Execute::Request::Kind::Cas;
+            request.version = _cas;
+        } else if (_base == Set) {
+            request.kind = Execute::Request::Kind::Set;
+        } else {
+            request.kind = (_base == Add) ? Execute::Request::Kind::Add : Execute::Request::Kind::Replace;
+        }
+        request.flags = load32(extras);
+        request.expire = int32_t(load32(extras + 4));
+        break;
+    case Append:
+        request.kind = Execute::Request::Kind::Append;
+        break;
+    case Prepend:
+        request.kind = Execute::Request::Kind::Prepend;
+        break;
+    case Delete:
+        request.kind = Execute::Request::Kind::Delete;
+        break;
+    case Increment:
+    case Decrement:
+        request.kind = (_base == Increment) ? Execute::Request::Kind::Incr : Execute::Request::Kind::Decr;
+        request.delta = load64(extras);
+        request.initial = load64(extras + 8);
+        request.create = load32(extras + 16) != NoInitial;
+        break;
+    case Touch:
+        request.kind = Execute::Request::Kind::Touch;
+        request.expire = int32_t(load32(extras));
+        break;
+    case Flush:
+        request.kind = Execute::Request::Kind::FlushAll;
+        request.expire = _extras_size ? int32_t(load32(extras)) : 0;
+        break;
+    default:
+        // Noop and quit are answered by Encode without touching storage
+        return true;
+    }
+
+    if (_key_size > 0) {
+        request.AddKey(extras + _extras_size, _key_size);
+    }
+    return true;
+}
+
+// See BinaryParser.h
+void BinaryParser::Encode(const Header &header, const Execute::Request &request, Execute::Response &result,
+                          Execute::Response &out) {
+    typedef Execute::Response::Status Outcome;
+    if (header.status != Success) {
+        _error(out, header, header.status);
+        return;
+    }
+
+    Outcome outcome = result.GetStatus();
+    switch (header.base) {
+    case Noop:
+        _response(out, header, Success, nullptr, 0, nullptr, 0, nullptr, 0);
+        break;
+
+    case Quit:
+        if (!header.quiet) {
+            _response(out, header, Success, nullptr, 0, nullptr, 0, nullptr, 0);
+        }
+        break;
+
+    case Get:
+    case GetK: {
+        // Key of the valid get request is always there
+        const char *key = nullptr;
+        std::size_t key_size = 0;
+        if (header.base == GetK) {
+            key = request.Key().data();
+            key_size = request.Key().size();
+        }
+
+        std::string *item = result.Item();
+        if (outcome != Outcome::Found || item == nullptr) {
+            if (header.quiet) {
+                break;
+            } else if (key_size > 0) {
+                _response(out, header, KeyNotFound, nullptr, 0, key, key_size, nullptr, 0);
+            } else {
+                _error(out, header, KeyNotFound);
+            }
+            break;
+        }
+
+        // Storage doesn't keep flags, value is moved over without its trailing \r\n
+        char flags[4];
+        store32(flags, 0);
+        std::size_t value_size = item->size() - 2;
+        _response(out, header, Success, flags, sizeof(flags), key, key_size, nullptr, value_size, result.Version());
+        out.Attach(std::move(*item), value_size);
+        break;
+    }
+
+    case Set:
+    case Add:
+    case Replace:
+    case Append:
+    case Prepend:
+        if (outcome == Outcome::Stored) {
+            if (!header.quiet) {
+                _response(out, header, Success, nullptr, 0, nullptr, 0, nullptr, 0, result.Version());
+            }
+        } else if (header.base == Add || outcome == Outcome::Exists) {
+            _error(out, header, KeyExists);
+        } else if (header.base == Replace || outcome == Outcome::NotFound) {
+            _error(out, header, KeyNotFound);
+        } else {
+            _error(out, header, ItemNotStored);
+        }
+        break;
+
+    case Delete:
+    case Touch:
+        if (outcome == Outcome::Deleted || outcome == Outcome::Touched) {
+            if (!header.quiet) {
+                _response(out, header, Success, nullptr, 0, nullptr, 0, nullptr, 0);
+            }
+        } else {
+            _error(out, header, KeyNotFound);
+        }
+        break;
+
+    case Increment:
+    case Decrement:
+        if (outcome == Outcome::Counted) {
+            if (!header.quiet) {
+                char value[8];
+                store64(value, result.Counter());
+                _response(out, header, Success, nullptr, 0, nullptr, 0, value, sizeof(value), result.Version());
+            }
+        } else if (outcome == Outcome::NotFound) {
+            _error(out, header, KeyNotFound);
+        } else {
+            _error(out, header, NonNumeric);
+        }
+        break;
+
+    case Flush:
+        if (outcome != Outcome::Ok) {
+            // Delayed flush is refused, see Execute::FlushAll
+            _error(out, header, InvalidArguments);
+        } else if (!header.quiet) {
+            _response(out, header, Success, nullptr, 0, nullptr, 0, nullptr, 0);
+        }
+        break;
+
+    default:
+        _error(out, header, UnknownCommand);
+    }
+}
+
+// See BinaryParser.h
+void BinaryParser::Reset() {
+    _head.clear();
+    _header_ready = false;
+    _complete = false;
+    _opcode = 0;
+    _extras_size = 0;
+    _key_size = 0;
+    _body_size = 0;
+    _opaque = 0;
+    _cas = 0;
+    _base = 0;
+    _quiet = false;
+    _status = Success;
+}
+
+// See BinaryParser.h
+const char *BinaryParser::Name() const {
+    switch (_base) {
+    case Get:
+        return "get";
+    case GetK:
+        return "getk";
+    case Set:
+        return "set";
+    case Add:
+        return "add";
+    case Replace:
+        return "replace";
+    case Delete:
+        return "delete";
+    case Append:
+        return "append";
+    case Prepend:
+        return "prepend";
+    case Increment:
+        return "incr";
+    case Decrement:
+        return "decr";
+    case Touch:
+        return "touch";
+    case Flush:
+        return "flush";
+    case Noop:
+        return "noop";
+    case Quit:
+        return "quit";
+    default:
+        return "";
+    }
+}
+
+// See BinaryParser.h
+void BinaryParser::_response(Execute::Response &out, const Header &request, Status status, const char *extras,
+                             std::size_t extras_size, const char *key, std::size_t key_size, const char *value,
+                             std::size_t value_size, uint64_t cas) {
+    char header[HeaderSize];
+    std::memset(header, 0, sizeof(header));
+    header[0] = char(ResponseMagic);
+    header[1] = char(request.opcode);
+    store16(header + 2, uint16_t(key_size));
+    header[4] = char(extras_size);
+    store16(header + 6, status);
+    store32(header + 8, uint32_t(extras_size + key_size + value_size));
+    store32(header + 12, request.opaque);
+    store64(header + 16, cas);
+
+    out.Append(header, sizeof(header));
+    if (extras_size > 0) {
+        out.Append(extras, extras_size);
+    }
+    if (key_size > 0) {
+        out.Append(key, key_size);
+    }
+    if (value != nullptr && value_size > 0) {
+        out.Append(value, value_size);
+    }
+}
+
+// See BinaryParser.h
+void BinaryParser::_error(Execute::Response &out, const Header &request, Status status) {
+    const char *text = message(status);
+    _response(out, request, status, nullptr, 0, nullptr, 0, text, std::strlen(text));
+}
+
+// See BinaryParser.h
+void BinaryParser::_validate() {
+    if (_status != Success) {
+        return;
+    }
+
+    std::size_t value_size = _body_size - _extras_size - _key_size;
+    bool valid = false;
+    switch (_base) {
+    case Get:
+    case GetK:
+    case Delete:
+        valid = _extras_size == 0 && _key_size > 0 && value_size == 0;
+        break;
+    case Set:
+    case Replace:
+        valid = _extras_size == 8 && _key_size > 0;
+        break;
+    case Add:
+        valid = _extras_size == 8 && _key_size > 0 && _cas == 0;
+        break;
+    case Append:
+    case Prepend:
+        valid = _extras_size == 0 && _key_size > 0;
+        break;
+    case Increment:
+    case Decrement:
+        valid = _extras_size == 20 && _key_size > 0 && value_size == 0;
+        break;
+    case Touch:
+        valid = _extras_size == 4 && _key_size > 0 && value_size == 0;
+        break;
+    case Flush:
+        valid = (_extras_size == 0 || _extras_size == 4) && _key_size == 0 && value_size == 0;
+        break;
+    case Noop:
+    case Quit:
+        valid = _extras_size == 0 && _key_size == 0 && value_size == 0;
+        break;
+    default:
+        _status = UnknownCommand;
+        return;
+    }
+
+    if (!valid || _key_size > MaxKeySize) {
+        _status = InvalidArguments;
+    }
+}
+
+} // namespace Protocol
+} // namespace Afina
@@ -0,0 +1,183 @@
+#ifndef AFINA_PROTOCOL_BINARY_PARSER_H
+#define AFINA_PROTOCOL_BINARY_PARSER_H
+
+#include <memory>
+#include <string>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Execute {
+class Request;
+class Response;
+} // namespace Execute
+namespace Protocol {
+
+/**
+ * # Memcached binary protocol parser
+ * Every request starts with fixed 24 bytes header followed by extras, key and value of the lengths given
+ * in the header, so nothing has to be tokenized. Parser collects header, extras and key, value is left for
+ * the caller as a body of the command, just like the data block of text protocol.
+ *
+ * Requests are executed as the same Execute::Request records text protocol fills in, Encode builds binary
+ * response out of the outcome command reports, see Execute::Response
+ */
+class BinaryParser {
+public:
+    // First byte of every request and response
+    static constexpr uint8_t RequestMagic = 0x80;
+    static constexpr uint8_t ResponseMagic = 0x81;
+
+    // Size of the fixed part of every request and response
+    static constexpr std::size_t HeaderSize = 24;
+
+    enum Opcode : uint8_t {
+        Get = 0x00,
+        Set = 0x01,
+        Add = 0x02,
+        Replace = 0x03,
+        Delete = 0x04,
+        Increment = 0x05,
+        Decrement = 0x06,
+        Quit = 0x07,
+        Flush = 0x08,
+        GetQ = 0x09,
+        Noop = 0x0a,
+        Version = 0x0b,
+        GetK = 0x0c,
+        GetKQ = 0x0d,
+        Append = 0x0e,
+        Prepend = 0x0f,
+        Stat = 0x10,
+        SetQ = 0x11,
+        AddQ = 0x12,
+        ReplaceQ = 0x13,
+        DeleteQ = 0x14,
+        IncrementQ = 0x15,
+        DecrementQ = 0x16,
+        QuitQ = 0x17,
+        FlushQ = 0x18,
+        AppendQ = 0x19,
+        PrependQ = 0x1a,
+        Touch = 0x1c
+    };
+
+    enum Status : uint16_t {
+        Success = 0x0000,
+        KeyNotFound = 0x0001,
+        KeyExists = 0x0002,
+        ValueTooLarge = 0x0003,
+        InvalidArguments = 0x0004,
+        ItemNotStored = 0x0005,
+        NonNumeric = 0x0006,
+        UnknownCommand = 0x0081,
+        OutOfMemory = 0x0082
+    };
+
+    BinaryParser() { Reset(); }
+
+    /**
+     * Push given bytes into parser input. Method returns true once header, extras and key of the request
+     * are complete, in a such case method Build will fill the request in
+     *
+     * @param input string to be added to the parsed input
+     * @param size number of bytes in the input buffer that could be read
+     * @param parsed output parameter tells how many bytes was consumed from the string
+     * @return true if request has been parsed out
+     */
+    bool Parse(const char *input, const size_t size, size_t &parsed);
+
+    /**
+     * Fills request in for the parsed one, body_size is set to the size of the value which follows. Request
+     * is left of kind None if it doesn't need a command (noop, quit) or it can't be executed, Encode knows
+     * what to answer then. Returns false if request isn't parsed yet
+     */
+    bool Build(Execute::Request &request, size_t &body_size) const;
+
+    /**
+     * Fields of the parsed request its response is built from, kept along with the request while parser goes
+     * on with the next one
+     */
+    struct Header {
+        uint8_t opcode;
+
+        // Opcode without quiet flag and whether flag was set
+        uint8_t base;
+        bool quiet;
+
+        uint32_t opaque;
+
+        // Whether request could be executed
+        Status status;
+    };
+
+    inline Header Parsed() const { return Header{_opcode, _base, _quiet, _opaque, _status}; }
+
+    /**
+     * Appends response for the request given its header, the request as Build has filled it in and the outcome
+     * of its command to out. Version of the item goes back as CAS of the response. Value of the found item is
+     * moved over from result instead of copied, result must be cleared afterwards. Quiet requests produce
+     * nothing on success
+     */
+    static void Encode(const Header &header, const Execute::Request &request, Execute::Response &result,
+                       Execute::Response &out);
+
+    /**
+     * Reset parse so that it could be used to parse out new request
+     */
+    void Reset();
+
+    /**
+     * Name of the parsed command
+     */
+    const char *Name() const;
+
+    /**
+     * Whether client asks to close connection
+     */
+    inline bool IsQuit() const { return _base == Quit; }
+
+    inline Status Error() const { return _status; }
+
+private:
+    // Appends single response to the request to out. If value is nullptr, only its size goes to the header and
+    // caller attaches value_size bytes of the value itself
+    static void _response(Execute::Response &out, const Header &request, Status status, const char *extras,
+                          std::size_t extras_size, const char *key, std::size_t key_size, const char *value,
+                          std::size_t value_size, uint64_t cas = 0);
+
+    // Appends response with error message to out
+    static void _error(Execute::Response &out, const Header &request, Status status);
+
+    // Checks that request has all the fields its command needs, sets _status otherwise
+    void _validate();
+
+    // Header, extras and key of the request
+    std::string _head;
+
+    // Whether header has been decoded
+    bool _header_ready;
+
+    // Whether header, extras and key are complete
+    bool _complete;
+
+    uint8_t _opcode;
+    uint8_t _extras_size;
+    uint16_t _key_size;
+    uint32_t _body_size;
+    uint32_t _opaque;
+    uint64_t _cas;
+
+    // Opcode without quiet flag and whether flag was set
+    uint8_t _base;
+    bool _quiet;
+
+    // Whether request could be executed
+    Status _status;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_BINARY_PARSER_H
@@ -0,0 +1,130 @@
+#include "Scanner.h"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AFINA_PROTOCOL_SIMD_SCANNER 1
+#include <immintrin.h>
+#else
+#define AFINA_PROTOCOL_SIMD_SCANNER 0
+#endif
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+const char *find_scalar(const char *begin, const char *end, char c) {
+    for (; begin < end; begin++) {
+        if (*begin == c) {
+            return begin;
+        }
+    }
+    return end;
+}
+
+#if AFINA_PROTOCOL_SIMD_SCANNER
+__attribute__((target("sse2"))) const char *find_sse2(const char *begin, const char *end, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; end - begin >= 16; begin += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return find_scalar(begin, end, c);
+}
+
+__attribute__((target("avx2"))) const char *find_avx2(const char *begin, const char *end, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; end - begin >= 32; begin += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    // Tail is shorter than a vector, commands lines are short so that is a common case
+    return find_sse2(begin, end, c);
+}
+#endif
+
+} // namespace
+
+const Scanner::FindFunction Scanner::_find = [] {
+    switch (Best()) {
+#if AFINA_PROTOCOL_SIMD_SCANNER
+    case Mode::AVX2:
+        return &find_avx2;
+    case Mode::SSE2:
+        return &find_sse2;
+#endif
+    default:
+        return &find_scalar;
+    }
+}();
+
+// See Scanner.h
+Scanner::Mode Scanner::Best() {
+    if (Supported(Mode::AVX2)) {
+        return Mode::AVX2;
+    } else if (Supported(Mode::SSE2)) {
+        return Mode::SSE2;
+    }
+    return Mode::Scalar;
+}
+
+// See Scanner.h
+bool Scanner::Supported(Mode mode) {
+#if AFINA_PROTOCOL_SIMD_SCANNER
+    // Could be called from static initialization, before CPU model gets detected otherwise
+    __builtin_cpu_init();
+#endif
+    switch (mode) {
+#if AFINA_PROTOCOL_SIMD_SCANNER
+    case Mode::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case Mode::SSE2:
+        return __builtin_cpu_supports("sse2");
+#endif
+    case Mode::Scalar:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// See Scanner.h
+const char *Scanner::Name(Mode mode) {
+    switch (mode) {
+    case Mode::AVX2:
+        return "avx2";
+    case Mode::SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+// See Scanner.h
+const char *Scanner::Find(Mode mode, const char *begin, const char *end, char c) {
+    if (!Supported(mode)) {
+        throw std::runtime_error(std::string("Scanner is not supported by CPU: ") + Name(mode));
+    }
+
+    switch (mode) {
+#if AFINA_PROTOCOL_SIMD_SCANNER
+    case Mode::AVX2:
+        return find_avx2(begin, end, c);
+    case Mode::SSE2:
+        return find_sse2(begin, end, c);
+#endif
+    default:
+        return find_scalar(begin, end, c);
+    }
+}
+
+} // namespace Protocol
+} // namespace Afina
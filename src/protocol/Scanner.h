@@ -0,0 +1,61 @@
+#ifndef AFINA_PROTOCOL_SCANNER_H
+#define AFINA_PROTOCOL_SCANNER_H
+
+#include <cstddef>
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Delimiter search in the protocol input
+ * Looks for line ends and spaces 16 or 32 bytes at a time. Implementation is chosen once at startup
+ * according to what CPU supports, so the binary built for generic x86-64 still uses AVX2 where it is
+ * available and doesn't crash where it is not
+ */
+class Scanner {
+public:
+    enum class Mode { Scalar, SSE2, AVX2 };
+
+    /**
+     * Best implementation supported by the current CPU, the one Find uses
+     */
+    static Mode Best();
+
+    /**
+     * Returns true if the current CPU is able to run given implementation
+     */
+    static bool Supported(Mode mode);
+
+    /**
+     * Human readable name of the implementation
+     */
+    static const char *Name(Mode mode);
+
+    /**
+     * Returns pointer to the first byte equal to c in [begin, end) or end if there is none
+     */
+    static inline const char *Find(const char *begin, const char *end, char c) { return _find(begin, end, c); }
+
+    /**
+     * Same as above using the given implementation, which must be supported
+     */
+    static const char *Find(Mode mode, const char *begin, const char *end, char c);
+
+    /**
+     * Returns true if data block of the given size ends with \r\n as protocol requires
+     */
+    static inline bool Terminated(const char *data, std::size_t size) {
+        return size >= 2 && data[size - 2] == '\r' && data[size - 1] == '\n';
+    }
+
+private:
+    typedef const char *(*FindFunction)(const char *, const char *, char);
+
+    // Implementation of Find selected for the current CPU
+    static const FindFunction _find;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_SCANNER_H
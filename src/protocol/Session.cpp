@@ -0,0 +1,323 @@
+#include "Session.h"
+#include "Scanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <afina/Storage.h>
+#include <afina/execute/Latency.h>
+#include <afina/execute/Request.h>
+
+#ifndef AFINA_TRACE_SAMPLING
+#define AFINA_TRACE_SAMPLING 1000
+#endif
+
+namespace Afina {
+namespace Protocol {
+
+constexpr std::size_t Session::MaxPreallocated;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+uint64_t nanoseconds_since(Clock::time_point begin) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+}
+
+} // namespace
+
+// See Session.h
+Session::Session(std::shared_ptr<Afina::Storage> storage, std::shared_ptr<spdlog::logger> tracer)
+    : _storage(storage), _tracer(tracer), _executed(0), _commands(0), _sampling(0), _batched(0) {
+    Reset();
+}
+
+// See Session.h
+Session::~Session() {}
+
+// See Session.h
+void Session::Process(const char *input, std::size_t size, Execute::Response &out) {
+    try {
+        Parse(input, size);
+    } catch (std::runtime_error &ex) {
+        // Commands received before the broken one are still executed
+        Flush(out);
+        throw;
+    }
+    Flush(out);
+}
+
+// See Session.h
+void Session::ReleaseMemory() {
+    for (std::size_t i = 0; i < _batch.size(); i++) {
+        // Data block of the command which is parsed already could still be in progress
+        if (i != _batched || !_parsed) {
+            std::string().swap(_batch[i].body);
+        }
+    }
+}
+
+// See Session.h
+void Session::Reset() {
+    _mode = Mode::Unknown;
+    _text.Reset();
+    _binary.Reset();
+    _parsed = false;
+    _body_size = 0;
+    _body_remains = 0;
+    for (auto &pending : _batch) {
+        pending.body.clear();
+    }
+    _batched = 0;
+    _unwritten.clear();
+    _closed = false;
+    _error.clear();
+}
+
+// See Session.h
+void Session::Fail(const std::string &error) {
+    _closed = true;
+    _error = error;
+}
+
+// See Session.h
+void Session::Parse(const char *input, std::size_t size) {
+    // Single input could complete several commands, for example:
+    // - input#0: [<command1 start>]
+    // - input#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+    _sampling = Execute::Latency::Sampling();
+    while (size > 0 && !_closed) {
+        if (_mode == Mode::Unknown) {
+            _mode = (uint8_t(input[0]) == BinaryParser::RequestMagic) ? Mode::Binary : Mode::Text;
+        }
+
+        if (!_parsed) {
+            // Only the call which completes command is measured, waiting for the rest of the line isn't parsing
+            bool measure = _sampling != 0 && _commands % _sampling == 0;
+            Clock::time_point begin;
+            if (measure) {
+                begin = Clock::now();
+            }
+
+            std::size_t parsed = 0;
+            bool complete =
+                (_mode == Mode::Text) ? _text.Parse(input, size, parsed) : _binary.Parse(input, size, parsed);
+            input += parsed;
+            size -= parsed;
+            if (!complete) {
+                // Parsers keep incomplete line or header inside, so the whole input is consumed
+                break;
+            }
+
+            _parsed = true;
+            if (_mode == Mode::Text) {
+                _text.Build(_next().request, _body_remains);
+                if (_text.HasBody()) {
+                    _body_remains += 2;
+                }
+            } else {
+                _binary.Build(_next().request, _body_remains);
+            }
+            _body_size = _body_remains;
+            _prepare_body();
+
+            Pending &next = _next();
+            next.measured = measure && next.request.kind != Execute::Request::Kind::None;
+            if (next.measured) {
+                next.parse_time = nanoseconds_since(begin);
+            }
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (_body_remains > 0) {
+            std::size_t to_read = std::min(_body_remains, size);
+            Pending &next = _next();
+            if (next.request.kind != Execute::Request::Kind::None) {
+                std::size_t offset = _body_size - _body_remains;
+                if (next.body.size() > offset) {
+                    std::memcpy(&next.body[offset], input, to_read);
+                } else {
+                    next.body.append(input, to_read);
+                }
+            }
+            input += to_read;
+            size -= to_read;
+            _body_remains -= to_read;
+            if (_body_remains > 0) {
+                break;
+            }
+        }
+
+        _enqueue();
+    }
+}
+
+// See Session.h
+char *Session::Window(std::size_t &size) {
+    if (!_parsed || _body_remains == 0 || _closed) {
+        return nullptr;
+    }
+
+    Pending &next = _next();
+    if (next.request.kind == Execute::Request::Kind::None || next.body.size() < _body_size) {
+        // Data block is either skipped or too large to be allocated in advance
+        return nullptr;
+    }
+    size = _body_remains;
+    return &next.body[_body_size - _body_remains];
+}
+
+// See Session.h
+void Session::Commit(std::size_t size) {
+    _body_remains -= std::min(size, _body_remains);
+    if (_body_remains == 0) {
+        _enqueue();
+    }
+}
+
+void Session::_prepare_body() {
+    Pending &next = _next();
+    next.body.clear();
+    if (next.request.kind == Execute::Request::Kind::None || _body_size > MaxPreallocated) {
+        return;
+    }
+
+    // Data block is received right into the memory storage is going to keep. Binary values get \r\n
+    // storage expects in advance
+    if (_mode == Mode::Text) {
+        next.body.resize(_body_size);
+    } else {
+        next.body.resize(_body_size + 2);
+        next.body[_body_size] = '\r';
+        next.body[_body_size + 1] = '\n';
+    }
+}
+
+Session::Pending &Session::_next() {
+    if (_batched == _batch.size()) {
+        _batch.emplace_back();
+    }
+    return _batch[_batched];
+}
+
+void Session::_enqueue() {
+    Pending &pending = _batch[_batched++];
+    _commands++;
+    pending.data_size = _body_size;
+    pending.bad_chunk = false;
+    pending.noreply = false;
+
+    if (_mode == Mode::Text) {
+        // Data block must be followed by \r\n, otherwise client and server disagree on its size
+        pending.bad_chunk = !pending.body.empty() && !Scanner::Terminated(pending.body.data(), pending.body.size());
+        pending.name = _text.Name();
+        pending.noreply = _text.NoReply();
+        _text.Reset();
+    } else {
+        if (pending.request.kind != Execute::Request::Kind::None && pending.body.size() == _body_size) {
+            // Storage keeps values in the text protocol format
+            pending.body.append("\r\n", 2);
+        }
+        pending.binary = _binary.Parsed();
+        pending.name = _binary.Name();
+        _closed = _binary.IsQuit();
+        _binary.Reset();
+    }
+
+    // Prepare for the next command
+    _parsed = false;
+}
+
+// See Session.h
+void Session::Flush(Execute::Response &out) {
+    // Commands of the previous flush which haven't been written had nothing to write
+    _unwritten.clear();
+    if (_batched == 0) {
+        return;
+    }
+
+    _storage->Batch([this](Afina::Storage &storage) {
+        for (std::size_t i = 0; i < _batched; i++) {
+            Pending &pending = _batch[i];
+            Clock::time_point begin;
+            if (pending.measured) {
+                begin = Clock::now();
+            }
+
+            pending.response.Clear();
+            if (pending.bad_chunk) {
+                pending.response.Append("CLIENT_ERROR bad data chunk");
+            } else {
+                pending.request.Execute(storage, pending.body, pending.response);
+            }
+
+            if (pending.measured) {
+                pending.storage_time = nanoseconds_since(begin);
+            }
+        }
+    });
+
+    for (std::size_t i = 0; i < _batched; i++) {
+        Pending &pending = _batch[i];
+#ifdef AFINA_TRACE_COMMANDS
+        _trace(pending);
+#endif
+        std::size_t out_size = out.Size();
+        if (_mode == Mode::Text) {
+            // Broken data block is reported anyway, client can't tell where the next command starts otherwise
+            if (!pending.noreply || pending.bad_chunk) {
+                out.Append(std::move(pending.response)).Append("\r\n", 2);
+            }
+        } else {
+            BinaryParser::Encode(pending.binary, pending.request, pending.response, out);
+        }
+        pending.body.clear();
+
+        if (pending.measured) {
+            Execute::Latency::Record(pending.request.kind, Execute::Latency::Stage::Parse, pending.parse_time);
+            Execute::Latency::Record(pending.request.kind, Execute::Latency::Stage::Storage, pending.storage_time);
+            // Commands client wants no response for, noreply and quiet ones, have nothing to be written
+            if (out.Size() != out_size) {
+                _unwritten.push_back(pending.request.kind);
+            }
+        }
+    }
+    _batched = 0;
+}
+
+// See Session.h
+void Session::BeginWrite() {
+    if (!_unwritten.empty()) {
+        _write_begin = Clock::now();
+    }
+}
+
+// See Session.h
+void Session::EndWrite() {
+    if (_unwritten.empty()) {
+        return;
+    }
+
+    uint64_t write_time = nanoseconds_since(_write_begin);
+    for (auto kind : _unwritten) {
+        Execute::Latency::Record(kind, Execute::Latency::Stage::Write, write_time);
+    }
+    _unwritten.clear();
+}
+
+// See Session.h
+void Session::_trace(const Pending &pending) {
+    if (_executed++ % AFINA_TRACE_SAMPLING != 0 || !_tracer || !_tracer->should_log(spdlog::level::trace)) {
+        return;
+    }
+
+    // Only status line goes to the log, values could be large and sensitive
+    std::string result = pending.response.Str();
+    std::size_t status = std::min(result.find("\r\n"), result.size());
+    _tracer->trace("{}: {} bytes of data -> {}", pending.name, pending.data_size, result.substr(0, status));
+}
+
+} // namespace Protocol
+} // namespace Afina
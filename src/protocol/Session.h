@@ -0,0 +1,199 @@
+#ifndef AFINA_PROTOCOL_SESSION_H
+#define AFINA_PROTOCOL_SESSION_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <afina/execute/Request.h>
+#include <afina/execute/Response.h>
+#include <spdlog/logger.h>
+
+#include "BinaryParser.h"
+#include "TextParser.h"
+
+namespace Afina {
+class Storage;
+namespace Protocol {
+
+/**
+ * # Protocol state of a single connection
+ * Turns bytes received from the client into responses: parses commands out of the stream, collects their
+ * data blocks, executes them against storage and encodes results. Network layer only moves bytes between
+ * socket and session.
+ *
+ * Protocol is chosen by the first byte client sends: binary requests always start with the magic byte,
+ * which can't start any text command. Both protocols fill the same Execute::Request records in
+ *
+ * Commands parsed out between two Flush calls make up a batch: they are executed against storage together,
+ * under a single lock acquisition, and their responses are appended to the output at once. Network layer
+ * feeds everything a single read brings and flushes once, so that every read costs one batch. Values read out of
+ * storage are attached to the output as is, so network layer writes them to the socket without copying.
+ *
+ * Every Execute::Latency::Sampling()-th command is measured: time it takes to parse and to execute against
+ * storage is recorded into latency histograms of the calling thread on Flush. Time network layer spends writing
+ * responses out is measured by BeginWrite and EndWrite and recorded for the commands of the last Flush.
+ *
+ * Executed commands could be traced to the given logger. Tracing is compiled in only with AFINA_TRACE_COMMANDS
+ * defined and then only every AFINA_TRACE_SAMPLING-th command of the session is written, without data blocks
+ */
+class Session {
+public:
+    /**
+     * Largest data block memory is allocated for as soon as command line arrives, larger ones grow as
+     * the data comes, so that a client can't make server allocate memory just by asking for it
+     */
+    static constexpr std::size_t MaxPreallocated = 1024 * 1024;
+
+    Session(std::shared_ptr<Afina::Storage> storage, std::shared_ptr<spdlog::logger> tracer = nullptr);
+    ~Session();
+
+    /**
+     * Consumes all given bytes, commands completed by them are added to the batch, but aren't executed until
+     * Flush. Part of the command which doesn't complete yet is kept until the next call.
+     *
+     * Throws std::runtime_error if client breaks the protocol, connection must be closed then. Commands
+     * parsed before the broken one are still in the batch
+     */
+    void Parse(const char *input, std::size_t size);
+
+    /**
+     * Executes the batch and appends responses of its commands to out
+     */
+    void Flush(Execute::Response &out);
+
+    /**
+     * Parses given bytes and flushes the batch, even if parse fails, see Parse
+     */
+    void Process(const char *input, std::size_t size, Execute::Response &out);
+
+    /**
+     * Space for the rest of the data block session is waiting for, nullptr if there is no such block or it
+     * isn't allocated in advance. Data block is received right into the memory storage is going to keep, so
+     * network layer could read there instead of passing bytes through its buffer and Process
+     *
+     * @param size output parameter, number of bytes session waits for
+     */
+    char *Window(std::size_t &size);
+
+    /**
+     * Accounts size bytes written at the address returned by Window, command is added to the batch once
+     * the data block is complete
+     */
+    void Commit(std::size_t size);
+
+    /**
+     * Mark start and end of the socket write which sends responses of the flushed commands out, time between
+     * them is recorded as the write stage of the measured ones. If network layer queues what socket doesn't
+     * accept, sending the queued part later isn't accounted
+     */
+    void BeginWrite();
+    void EndWrite();
+
+    /**
+     * Whether client asked to close connection or broke the protocol, rest of the input is ignored then
+     */
+    inline bool Closed() const { return _closed; }
+
+    /**
+     * Closes session because client broke the protocol. Responses of the commands received before the broken
+     * one are still to be sent, network layer closes connection after that
+     */
+    void Fail(const std::string &error);
+
+    /**
+     * How client broke the protocol, empty if it didn't
+     */
+    inline const std::string &Error() const { return _error; }
+
+    /**
+     * Frees memory kept for the data blocks, if there is no command waiting for one
+     */
+    void ReleaseMemory();
+
+    /**
+     * Drops partially received command and forgets protocol, so the session could serve new connection
+     */
+    void Reset();
+
+private:
+    enum class Mode : uint8_t { Unknown, Text, Binary };
+
+    // Command parsed out of the input and waiting for the batch execution
+    struct Pending {
+        // Command to execute, of kind None if request doesn't need any
+        Execute::Request request;
+        std::string body;
+        std::size_t data_size;
+        Execute::Response response;
+
+        // Fields of the binary request header its response is built from
+        BinaryParser::Header binary;
+        const char *name;
+
+        // Whether data block isn't terminated properly, text protocol only
+        bool bad_chunk;
+
+        // Whether client asked for no response, text protocol only. Binary quiet commands are handled by encoder
+        bool noreply;
+
+        // Whether command latency is measured and how long its stages took, in nanoseconds
+        bool measured;
+        uint64_t parse_time;
+        uint64_t storage_time;
+    };
+
+    // Entry of the batch the command being parsed goes to
+    Pending &_next();
+
+    // Allocates memory for the data block of the command being parsed, if it isn't too large
+    void _prepare_body();
+
+    // Adds command parsed into the next entry to the batch
+    void _enqueue();
+
+    // Writes sampled command and its result to the tracer
+    void _trace(const Pending &pending);
+
+    std::shared_ptr<Afina::Storage> _storage;
+    std::shared_ptr<spdlog::logger> _tracer;
+
+    // Commands executed in the session, drives trace sampling
+    uint64_t _executed;
+
+    // Commands parsed in the session and how often their latency is measured, drive latency sampling
+    uint64_t _commands;
+    uint32_t _sampling;
+
+    Mode _mode;
+    TextParser _text;
+    BinaryParser _binary;
+
+    // Whether command line or request header has been parsed out
+    bool _parsed;
+
+    // Size of the data block client sends for the command being parsed and how much of it is still expected
+    std::size_t _body_size;
+    std::size_t _body_remains;
+
+    // Commands to be executed, first _batched of them, command being parsed goes to the next one. Entries
+    // are reused to keep their memory, so in a steady state commands are parsed without allocations
+    std::vector<Pending> _batch;
+    std::size_t _batched;
+
+    // Kinds of the measured commands flushed but not written out yet and when their write has started
+    std::vector<Execute::Request::Kind> _unwritten;
+    std::chrono::steady_clock::time_point _write_begin;
+
+    bool _closed;
+    std::string _error;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_SESSION_H
@@ -0,0 +1,390 @@
+#include "TextParser.h"
+#include "Scanner.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <afina/execute/Request.h>
+
+namespace Afina {
+namespace Protocol {
+
+constexpr std::size_t TextParser::MaxLineSize;
+
+namespace {
+
+// Returns next space separated token of the line and moves position past it
+TextParser::Span next_token(const char *&pos, const char *end) {
+    const char *space = Scanner::Find(pos, end, ' ');
+    TextParser::Span result{pos, std::size_t(space - pos)};
+    pos = (space == end) ? end : space + 1;
+    return result;
+}
+
+// Returns next token of the line which must be a key
+TextParser::Span next_key(const char *&pos, const char *end) {
+    TextParser::Span key = next_token(pos, end);
+    if (key.size == 0) {
+        throw std::runtime_error("Key is missing");
+    }
+    return key;
+}
+
+// Checks whether the token is "noreply", in place
+bool is_noreply(const TextParser::Span &token) { return token.size == 7 && std::memcmp(token.data, "noreply", 7) == 0; }
+
+// Parses optional "noreply" token which ends the line, returns whether it is there
+bool parse_noreply(const char *&pos, const char *end) {
+    if (pos >= end) {
+        return false;
+    }
+
+    TextParser::Span token = next_token(pos, end);
+    if (!is_noreply(token)) {
+        throw std::runtime_error("Unexpected token: " + token.str());
+    }
+    return true;
+}
+
+// Parses decimal number fitting into [min, max], leading minus is allowed only if min is negative
+int64_t parse_number(const TextParser::Span &token, int64_t min, int64_t max, const char *field) {
+    if (token.size == 0) {
+        throw std::runtime_error(std::string(field) + " field is missing");
+    }
+
+    std::size_t pos = 0;
+    bool negative = false;
+    if (min < 0 && token.data[0] == '-') {
+        negative = true;
+        pos++;
+    }
+    if (pos == token.size) {
+        throw std::runtime_error(std::string(field) + " field has no digits");
+    }
+
+    int64_t limit = negative ? -min : max;
+    int64_t result = 0;
+    for (; pos < token.size; pos++) {
+        char c = token.data[pos];
+        if (c < '0' || c > '9') {
+            throw std::runtime_error(std::string(field) + " field is not a number");
+        }
+        result = result * 10 + (c - '0');
+        if (result > limit) {
+            throw std::runtime_error(std::string(field) + " field overflow");
+        }
+    }
+    return negative ? -result : result;
+}
+
+// Parses decimal number taking the whole range of uint64_t
+uint64_t parse_unsigned(const TextParser::Span &token, const char *field) {
+    if (token.size == 0) {
+        throw std::runtime_error(std::string(field) + " field is missing");
+    }
+
+    uint64_t result = 0;
+    for (std::size_t pos = 0; pos < token.size; pos++) {
+        char c = token.data[pos];
+        if (c < '0' || c > '9') {
+            throw std::runtime_error(std::string(field) + " field is not a number");
+        }
+        uint64_t digit = c - '0';
+        if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+            throw std::runtime_error(std::string(field) + " field overflow");
+        }
+        result = result * 10 + digit;
+    }
+    return result;
+}
+
+} // namespace
+
+// See TextParser.h
+bool TextParser::Parse(const char *input, const size_t size, size_t &parsed) {
+    parsed = 0;
+    if (_complete) {
+        return true;
+    }
+
+    const char *lf = Scanner::Find(input, input + size, '\n');
+    if (lf == input + size) {
+        // Line continues in the next input, keep what is already here
+        if (_line.size() + size > MaxLineSize) {
+            throw std::runtime_error("Command line is too long");
+        }
+        _line.append(input, size);
+        parsed = size;
+        return false;
+    }
+
+    parsed = lf - input + 1;
+    if (_line.empty()) {
+        _parse_line(input, parsed - 1);
+    } else {
+        _line.append(input, parsed);
+        _parse_line(_line.data(), _line.size() - 1);
+    }
+    _complete = true;
+    return true;
+}
+
+// See TextParser.h
+bool TextParser::Build(Execute::Request &request, size_t &body_size) const {
+    request.Reset();
+    if (!_complete) {
+        return false;
+    }
+
+    body_size = _bytes;
+    switch (_command) {
+    case Command::Set:
+        request.kind = Execute::Request::Kind::Set;
+        break;
+    case Command::Add:
+        request.kind = Execute::Request::Kind::Add;
+        break;
+    case Command::Replace:
+        request.kind = Execute::Request::Kind::Replace;
+        break;
+    case Command::Cas:
+        request.kind = Execute::Request::Kind::Cas;
+        break;
+    case Command::Append:
+        request.kind = Execute::Request::Kind::Append;
+        break;
+    case Command::Prepend:
+        request.kind = Execute::Request::Kind::Prepend;
+        break;
+    case Command::Get:
+        request.kind = Execute::Request::Kind::Get;
+        break;
+    case Command::Gets:
+        request.kind = Execute::Request::Kind::Gets;
+        break;
+    case Command::Delete:
+        request.kind = Execute::Request::Kind::Delete;
+        break;
+    case Command::Incr:
+        request.kind = Execute::Request::Kind::Incr;
+        break;
+    case Command::Decr:
+        request.kind = Execute::Request::Kind::Decr;
+        break;
+    case Command::Touch:
+        request.kind = Execute::Request::Kind::Touch;
+        break;
+    case Command::FlushAll:
+        request.kind = Execute::Request::Kind::FlushAll;
+        break;
+    case Command::Stats:
+        request.kind = Execute::Request::Kind::Stats;
+        break;
+    default:
+        throw std::runtime_error("Unsupported command");
+    }
+
+    for (const Span &key : _keys) {
+        request.AddKey(key.data, key.size);
+    }
+    request.flags = _flags;
+    request.expire = _exprtime;
+    request.delta = _delta;
+    request.version = _version;
+    return true;
+}
+
+// See TextParser.h
+void TextParser::Reset() {
+    _complete = false;
+    _line.clear();
+    _command = Command::Unknown;
+    _keys.clear();
+    _flags = 0;
+    _exprtime = 0;
+    _bytes = 0;
+    _delta = 0;
+    _version = 0;
+    _noreply = false;
+}
+
+// See TextParser.h
+const char *TextParser::Name() const {
+    switch (_command) {
+    case Command::Set:
+        return "set";
+    case Command::Add:
+        return "add";
+    case Command::Replace:
+        return "replace";
+    case Command::Cas:
+        return "cas";
+    case Command::Append:
+        return "append";
+    case Command::Prepend:
+        return "prepend";
+    case Command::Get:
+        return "get";
+    case Command::Gets:
+        return "gets";
+    case Command::Delete:
+        return "delete";
+    case Command::Incr:
+        return "incr";
+    case Command::Decr:
+        return "decr";
+    case Command::Touch:
+        return "touch";
+    case Command::FlushAll:
+        return "flush_all";
+    case Command::Stats:
+        return "stats";
+    default:
+        return "";
+    }
+}
+
+// See TextParser.h
+TextParser::Command TextParser::_lookup(const char *name, std::size_t size) {
+    switch (size) {
+    case 3:
+        if (name[0] == 's' && name[1] == 'e' && name[2] == 't') {
+            return Command::Set;
+        } else if (name[0] == 'g' && name[1] == 'e' && name[2] == 't') {
+            return Command::Get;
+        } else if (name[0] == 'a' && name[1] == 'd' && name[2] == 'd') {
+            return Command::Add;
+        } else if (name[0] == 'c' && name[1] == 'a' && name[2] == 's') {
+            return Command::Cas;
+        }
+        break;
+    case 4:
+        if (std::memcmp(name, "gets", 4) == 0) {
+            return Command::Gets;
+        } else if (std::memcmp(name, "incr", 4) == 0) {
+            return Command::Incr;
+        } else if (std::memcmp(name, "decr", 4) == 0) {
+            return Command::Decr;
+        }
+        break;
+    case 5:
+        if (std::memcmp(name, "stats", 5) == 0) {
+            return Command::Stats;
+        } else if (std::memcmp(name, "touch", 5) == 0) {
+            return Command::Touch;
+        }
+        break;
+    case 6:
+        if (std::memcmp(name, "append", 6) == 0) {
+            return Command::Append;
+        } else if (std::memcmp(name, "delete", 6) == 0) {
+            return Command::Delete;
+        }
+        break;
+    case 7:
+        if (std::memcmp(name, "prepend", 7) == 0) {
+            return Command::Prepend;
+        } else if (std::memcmp(name, "replace", 7) == 0) {
+            return Command::Replace;
+        }
+        break;
+    case 9:
+        if (std::memcmp(name, "flush_all", 9) == 0) {
+            return Command::FlushAll;
+        }
+        break;
+    }
+    return Command::Unknown;
+}
+
+// See TextParser.h
+void TextParser::_parse_line(const char *line, std::size_t size) {
+    if (size == 0 || line[size - 1] != '\r') {
+        throw std::runtime_error("Command line must end with \\r\\n");
+    }
+
+    const char *pos = line;
+    const char *end = line + size - 1;
+    Span name = next_token(pos, end);
+    _command = _lookup(name.data, name.size);
+
+    switch (_command) {
+    case Command::Set:
+    case Command::Add:
+    case Command::Replace:
+    case Command::Cas:
+    case Command::Append:
+    case Command::Prepend: {
+        _keys.push_back(next_key(pos, end));
+        _flags = parse_number(next_token(pos, end), 0, std::numeric_limits<uint32_t>::max(), "Flags");
+        _exprtime = parse_number(next_token(pos, end), std::numeric_limits<int32_t>::min(),
+                                 std::numeric_limits<int32_t>::max(), "Expire time");
+        _bytes = parse_number(next_token(pos, end), 0, std::numeric_limits<uint32_t>::max(), "Bytes");
+        if (_command == Command::Cas) {
+            _version = parse_unsigned(next_token(pos, end), "Cas unique");
+        }
+        _noreply = parse_noreply(pos, end);
+        break;
+    }
+
+    case Command::Get:
+    case Command::Gets:
+        while (pos < end) {
+            Span key = next_token(pos, end);
+            if (key.size == 0) {
+                throw std::runtime_error("Empty key");
+            }
+            _keys.push_back(key);
+        }
+        if (_keys.empty()) {
+            throw std::runtime_error("Client provides no key to retrive");
+        }
+        break;
+
+    case Command::Delete:
+        _keys.push_back(next_key(pos, end));
+        _noreply = parse_noreply(pos, end);
+        break;
+
+    case Command::Incr:
+    case Command::Decr:
+        _keys.push_back(next_key(pos, end));
+        _delta = parse_unsigned(next_token(pos, end), "Value");
+        _noreply = parse_noreply(pos, end);
+        break;
+
+    case Command::Touch:
+        _keys.push_back(next_key(pos, end));
+        _exprtime = parse_number(next_token(pos, end), std::numeric_limits<int32_t>::min(),
+                                 std::numeric_limits<int32_t>::max(), "Expire time");
+        _noreply = parse_noreply(pos, end);
+        break;
+
+    case Command::FlushAll: {
+        // Delay is optional, so the only token could be noreply as well
+        const char *delay = pos;
+        if (pos < end && !is_noreply(next_token(delay, end))) {
+            _exprtime = parse_number(next_token(pos, end), 0, std::numeric_limits<int32_t>::max(), "Delay");
+        }
+        _noreply = parse_noreply(pos, end);
+        break;
+    }
+
+    case Command::Stats:
+        // Group of statistics is optional, see Execute::Stats
+        if (pos < end) {
+            _keys.push_back(next_key(pos, end));
+        }
+        if (pos < end) {
+            throw std::runtime_error("Unexpected token: " + next_token(pos, end).str());
+        }
+        break;
+
+    default:
+        throw std::runtime_error("Unknown command name: " + name.str());
+    }
+}
+
+} // namespace Protocol
+} // namespace Afina
@@ -0,0 +1,153 @@
+#ifndef AFINA_PROTOCOL_TEXT_PARSER_H
+#define AFINA_PROTOCOL_TEXT_PARSER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Execute {
+class Request;
+} // namespace Execute
+namespace Protocol {
+
+/**
+ * # Memcached text protocol parser
+ * Same subset of the protocol and the same interface as Parser, but works with whole command lines rather
+ * than single characters: line end and spaces between tokens are found with Scanner, command name is
+ * recognized by its length and bytes without any string comparison.
+ *
+ * Parser doesn't copy anything out of the input if the command line arrives in one piece, keys are just
+ * spans pointing into the input buffer, so they stay valid only until the buffer is changed. Line which
+ * is split between several inputs is collected in the internal buffer that keeps its capacity across
+ * commands, so in a steady state parser doesn't allocate memory at all
+ */
+class TextParser {
+public:
+    /**
+     * Commands parser knows about
+     */
+    enum class Command : uint8_t {
+        Unknown,
+        Set,
+        Add,
+        Replace,
+        Cas,
+        Append,
+        Prepend,
+        Get,
+        Gets,
+        Delete,
+        Incr,
+        Decr,
+        Touch,
+        FlushAll,
+        Stats
+    };
+
+    /**
+     * Part of the command line
+     */
+    struct Span {
+        const char *data;
+        std::size_t size;
+
+        inline std::string str() const { return std::string(data, size); }
+    };
+
+    /**
+     * Longest command line parser agrees to collect, key lines of real clients are way shorter
+     */
+    static constexpr std::size_t MaxLineSize = 64 * 1024;
+
+    TextParser() { Reset(); }
+
+    /**
+     * Push given string into parser input. Method returns true if it was a command parsed out
+     * from comulative input. In a such case method Build will fill the request in
+     *
+     * @param input sttring to be added to the parsed input
+     * @param parsed output parameter tells how many bytes was consumed from the string
+     * @return true if command has been parsed out
+     */
+    bool Parse(const std::string &input, size_t &parsed) { return Parse(input.data(), input.size(), parsed); }
+
+    /**
+     * Push given string into parser input. Method returns true if it was a command parsed out
+     * from comulative input. In a such case method Build will fill the request in
+     *
+     * @param input string to be added to the parsed input
+     * @param size number of bytes in the input buffer that could be read
+     * @param parsed output parameter tells how many bytes was consumed from the string
+     * @return true if command has been parsed out
+     */
+    bool Parse(const char *input, const size_t size, size_t &parsed);
+
+    /**
+     * Fills request in with the parsed command, request memory is reused. In case if it wasn't enough input
+     * to parse command out method returns false
+     */
+    bool Build(Execute::Request &request, size_t &body_size) const;
+
+    /**
+     * Reset parse so that it could be used to parse out new command
+     */
+    void Reset();
+
+    /**
+     * Name of the parsed command, empty string if command isn't parsed yet
+     */
+    const char *Name() const;
+
+    /**
+     * Whether command is followed by data block, which is there even if its size is 0
+     */
+    inline bool HasBody() const {
+        return _command == Command::Set || _command == Command::Add || _command == Command::Replace ||
+               _command == Command::Cas || _command == Command::Append || _command == Command::Prepend;
+    }
+
+    inline Command Kind() const { return _command; }
+    inline const std::vector<Span> &Keys() const { return _keys; }
+    inline uint32_t Flags() const { return _flags; }
+    inline int32_t ExpireTime() const { return _exprtime; }
+    inline uint32_t Bytes() const { return _bytes; }
+    inline uint64_t Delta() const { return _delta; }
+    inline uint64_t Version() const { return _version; }
+
+    /**
+     * Whether client asked not to send the response back
+     */
+    inline bool NoReply() const { return _noreply; }
+
+private:
+    // Recognizes command by its name
+    static Command _lookup(const char *name, std::size_t size);
+
+    // Parses complete command line, the one without trailing \r\n
+    void _parse_line(const char *line, std::size_t size);
+
+    // Whether the whole command line has been seen
+    bool _complete;
+
+    // Start of the line which didn't fit into a single input
+    std::string _line;
+
+    // Fields of the command, see Parser for the details
+    Command _command;
+    std::vector<Span> _keys;
+    uint32_t _flags;
+    int32_t _exprtime;
+    uint32_t _bytes;
+    uint64_t _delta;
+    uint64_t _version;
+    bool _noreply;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_TEXT_PARSER_H
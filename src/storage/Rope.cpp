@@ -0,0 +1,115 @@
+#include "Rope.h"
+
+#include <utility>
+
+namespace Afina {
+namespace Backend {
+
+// See Rope.h
+void Rope::Assign(std::string &&value) {
+    _main = std::move(value);
+    _front.clear();
+    _back.clear();
+    _size = _main.size();
+}
+
+// See Rope.h
+void Rope::Append(std::string &&data) {
+    if (data.empty()) {
+        return;
+    }
+
+    _size += data.size();
+    if (_size == data.size()) {
+        _main = std::move(data);
+        return;
+    }
+
+    // Piece which isn't larger than the one after it absorbs it, so sizes of the pieces decrease towards
+    // the end. That keeps number of pieces logarithmic and each byte gets copied only a few times
+    _back.emplace_back(std::move(data));
+    while (_back.size() > 1 && _back[_back.size() - 2].size() <= _back.back().size()) {
+        _back[_back.size() - 2] += _back.back();
+        _back.pop_back();
+    }
+}
+
+// See Rope.h
+void Rope::Prepend(std::string &&data) {
+    if (data.empty()) {
+        return;
+    }
+
+    _size += data.size();
+    if (_size == data.size()) {
+        _main = std::move(data);
+        return;
+    }
+
+    // Same as for Append, the last piece is the first one in the value
+    _front.emplace_back(std::move(data));
+    while (_front.size() > 1 && _front[_front.size() - 2].size() <= _front.back().size()) {
+        std::string &outer = _front.back();
+        outer += _front[_front.size() - 2];
+        _front[_front.size() - 2].swap(outer);
+        _front.pop_back();
+    }
+}
+
+// See Rope.h
+void Rope::Trim(std::size_t size) {
+    _size -= size;
+    while (size > 0) {
+        // Bytes are cut from the last segment of the value, whichever list it belongs to
+        std::string *last;
+        if (!_back.empty()) {
+            last = &_back.back();
+        } else if (!_main.empty() || _front.empty()) {
+            last = &_main;
+        } else {
+            last = &_front.front();
+        }
+
+        if (last->size() > size) {
+            last->resize(last->size() - size);
+            return;
+        }
+
+        size -= last->size();
+        if (!_back.empty()) {
+            _back.pop_back();
+        } else if (last == &_main) {
+            _main.clear();
+        } else {
+            _front.erase(_front.begin());
+        }
+    }
+}
+
+// See Rope.h
+const std::string &Rope::Flat() {
+    if (!_front.empty() || !_back.empty()) {
+        _compact();
+    }
+    return _main;
+}
+
+void Rope::_compact() {
+    std::string result;
+    result.reserve(_size);
+    for (auto it = _front.rbegin(); it != _front.rend(); it++) {
+        result += *it;
+    }
+    result += _main;
+    for (auto &piece : _back) {
+        result += piece;
+    }
+
+    // Piece lists give their memory back, the value is most likely read now rather than extended
+    _main.swap(result);
+    std::vector<std::string>().swap(_front);
+    std::vector<std::string>().swap(_back);
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,68 @@
+#ifndef AFINA_STORAGE_ROPE_H
+#define AFINA_STORAGE_ROPE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Value made of segments
+ * Main segment plus pieces added in front of it and after it, so that appending or prepending data costs
+ * only the size of the data, existing bytes aren't moved. Small pieces are merged as they come, so there
+ * are always only a few of them, and everything is glued together when value is read as a whole: reads of
+ * a value that doesn't change stay plain copies.
+ *
+ * Value which never got pieces is just a string, empty piece lists don't allocate any memory
+ */
+class Rope {
+public:
+    Rope() : _size(0) {}
+    explicit Rope(std::string &&value) : _main(std::move(value)), _size(_main.size()) {}
+
+    inline std::size_t Size() const { return _size; }
+
+    /**
+     * Replaces the whole value, memory of the given string is taken over
+     */
+    void Assign(std::string &&value);
+
+    /**
+     * Adds data to the end of value, memory of the data is taken over
+     */
+    void Append(std::string &&data);
+
+    /**
+     * Adds data to the start of value, memory of the data is taken over
+     */
+    void Prepend(std::string &&data);
+
+    /**
+     * Cuts size bytes off the end of value, size must not exceed Size()
+     */
+    void Trim(std::size_t size);
+
+    /**
+     * Whole value as a single string, pieces are glued together first
+     */
+    const std::string &Flat();
+
+private:
+    // Glues all pieces into the main segment
+    void _compact();
+
+    std::string _main;
+
+    // Pieces prepended to the main segment, the last one goes first, and the pieces appended to it
+    std::vector<std::string> _front;
+    std::vector<std::string> _back;
+
+    std::size_t _size;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_ROPE_H
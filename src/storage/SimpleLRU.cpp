@@ -1,58 +1,156 @@
 #include "SimpleLRU.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace Afina {
 namespace Backend {
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Put(const std::string &key, const std::string &value) {
+bool SimpleLRU::Put(const std::string &key, std::string value, uint64_t *version) {
+    auto it = _lru_index.find(key);
+    bool stored = (it == _lru_index.end()) ? _insert_kv(key, value) : _update_value(it->second.get(), value);
+    _set_version(version, stored ? _version : 0);
+    return stored;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::PutIfAbsent(const std::string &key, std::string value, uint64_t *version) {
+    bool stored = _lru_index.find(key) == _lru_index.end() && _insert_kv(key, value);
+    _set_version(version, stored ? _version : 0);
+    return stored;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Set(const std::string &key, std::string value, uint64_t *version) {
+    auto it = _lru_index.find(key);
+    bool stored = it != _lru_index.end() && _update_value(it->second.get(), value);
+    _set_version(version, stored ? _version : 0);
+    return stored;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Delete(const std::string &key) {
     auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
-        return _insert_kv(key, value);
-    } else {
-        return _update_kv(key, value);
+        return false;
     }
+    return _delete(it->second.get());
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+bool SimpleLRU::Get(const std::string &key, std::string &value, uint64_t *version) {
     auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
-        return _insert_kv(key, value);
-    } else {
         return false;
     }
+    value = it->second.get().value.Flat();
+    _set_version(version, it->second.get().version);
+    return _move_to_tail(it->second.get());
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Set(const std::string &key, const std::string &value) {
+bool SimpleLRU::CompareAndSet(const std::string &key, std::string value, uint64_t &version) {
     auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
+        version = 0;
         return false;
-    } else {
-        return _update_kv(key, value);
     }
+
+    lru_node &node = it->second.get();
+    if (node.version != version) {
+        version = node.version;
+        return false;
+    }
+
+    bool stored = _update_value(node, value);
+    version = node.version;
+    return stored;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Delete(const std::string &key) {
+bool SimpleLRU::Update(const std::string &key, const std::function<bool(std::string &value)> &fn,
+                       uint64_t *version) {
+    _set_version(version, 0);
     auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
         return false;
     }
-    return _delete(it->second.get());
+
+    lru_node &node = it->second.get();
+    std::string value = node.value.Flat();
+    if (!fn(value)) {
+        _set_version(version, node.version);
+        return _move_to_tail(node);
+    }
+    if (!_update_value(node, value)) {
+        return false;
+    }
+    _set_version(version, node.version);
+    return true;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Get(const std::string &key, std::string &value) {
+bool SimpleLRU::Append(const std::string &key, std::string data, std::size_t trim, uint64_t *version) {
+    _set_version(version, 0);
+    auto it = _lru_index.find(key);
+    if (it == _lru_index.end()) {
+        return false;
+    }
+
+    lru_node &node = it->second.get();
+    trim = std::min(trim, node.value.Size());
+    if (!_resize(node, node.key.size() + node.value.Size() - trim + data.size())) {
+        return false;
+    }
+    node.value.Trim(trim);
+    node.value.Append(std::move(data));
+    node.version = ++_version;
+    _set_version(version, node.version);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Prepend(const std::string &key, std::string data, uint64_t *version) {
+    _set_version(version, 0);
+    auto it = _lru_index.find(key);
+    if (it == _lru_index.end()) {
+        return false;
+    }
+
+    lru_node &node = it->second.get();
+    if (!_resize(node, node.key.size() + node.value.Size() + data.size())) {
+        return false;
+    }
+    node.value.Prepend(std::move(data));
+    node.version = ++_version;
+    _set_version(version, node.version);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Touch(const std::string &key) {
     auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
         return false;
     }
-    value = it->second.get().value;
     return _move_to_tail(it->second.get());
 }
 
-bool SimpleLRU::_insert_kv(const std::string &key, const std::string &value) {
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::Clear() {
+    _lru_index.clear();
+    while (_lru_head != nullptr) {
+        // Unlink nodes one by one, destruction of the whole chain at once is recursive
+        std::unique_ptr<lru_node> next;
+        next.swap(_lru_head->next);
+        _lru_head.swap(next);
+    }
+    _lru_tail = nullptr;
+    _free_size = _max_size;
+}
+
+bool SimpleLRU::_insert_kv(const std::string &key, std::string &value) {
     size_t size = key.size() + value.size();
     if (size > _max_size) {
         return false;
@@ -60,33 +158,34 @@ bool SimpleLRU::_insert_kv(const std::string &key, const std::string &value) {
     while (size > _free_size) {
         _delete_oldest();
     }
-    lru_node *new_node(new lru_node(key, value));
-    // std::unique_ptr<lru_node> new_node(new lru_node(key, value));
+    lru_node *new_node(new lru_node(key, std::move(value), ++_version));
     _lru_index.insert(std::make_pair(std::reference_wrapper<const std::string>(new_node->key),
-                                     std::reference_wrapper<lru_node>(*new_node)
-                                     // std::reference_wrapper<lru_node>(*new_node.get())
-                                     ));
+                                     std::reference_wrapper<lru_node>(*new_node)));
     _free_size -= size;
     return _insert(*new_node);
-    // return _insert(*new_node.get());
 }
 
-bool SimpleLRU::_update_kv(const std::string &key, const std::string &value) {
+bool SimpleLRU::_update_value(lru_node &node, std::string &value) {
+    if (!_resize(node, node.key.size() + value.size())) {
+        return false;
+    }
+    node.value.Assign(std::move(value));
+    node.version = ++_version;
+    return true;
+}
 
-    size_t size = key.size() + value.size();
+bool SimpleLRU::_resize(lru_node &node, std::size_t size) {
     if (size > _max_size) {
         return false;
     }
 
-    auto it = _lru_index.find(key);
-    size_t prev_size = it->second.get().key.size() + it->second.get().value.size();
-    _move_to_tail(it->second.get());
+    size_t prev_size = node.key.size() + node.value.Size();
+    _move_to_tail(node);
     while (size > _free_size + prev_size) {
         _delete_oldest();
     }
-    _free_size += prev_size - size;
-
-    it->second.get().value = value;
+    _free_size += prev_size;
+    _free_size -= size;
     return true;
 }
 
@@ -130,14 +229,17 @@ bool SimpleLRU::_delete(lru_node &node) {
     if (node.prev == nullptr) { // Node is first
         return _delete_oldest();
     } else {
-        size_t size = node.key.size() + node.value.size();
+        size_t size = node.key.size() + node.value.Size();
         _lru_index.erase(node.key);
+
+        // Take ownership of the node from its predecessor, it is destroyed on return
+        std::unique_ptr<lru_node> owner;
+        owner.swap(node.prev->next);
         if (node.next == nullptr) { // Node is last
-            node.prev->next.swap(node.next);
             _lru_tail = node.prev;
         } else { // Node is in center
-            node.prev->next.swap(node.next);
             node.next->prev = node.prev;
+            node.prev->next.swap(node.next);
         }
         _free_size += size;
         return true;
@@ -145,14 +247,16 @@ bool SimpleLRU::_delete(lru_node &node) {
 }
 
 bool SimpleLRU::_delete_oldest() {
-    size_t size = _lru_head->key.size() + _lru_head->value.size();
+    size_t size = _lru_head->key.size() + _lru_head->value.Size();
     _lru_index.erase(_lru_head->key);
-    if (_lru_head->next == nullptr) {
-        _lru_head = nullptr;
+
+    std::unique_ptr<lru_node> owner;
+    owner.swap(_lru_head);
+    _lru_head.swap(owner->next);
+    if (_lru_head == nullptr) {
         _lru_tail = nullptr;
     } else {
-        _lru_head.swap(_lru_head->next);
-        _lru_head->next->prev = nullptr;
+        _lru_head->prev = nullptr;
     }
     _free_size += size;
     return true;
@@ -8,6 +8,8 @@
 
 #include <afina/Storage.h>
 
+#include "Rope.h"
+
 namespace Afina {
 namespace Backend {
 
@@ -18,7 +20,7 @@ namespace Backend {
 class SimpleLRU : public Afina::Storage {
 public:
     SimpleLRU(size_t max_size = 1024)
-        : _max_size(max_size), _free_size(max_size), _lru_head(nullptr), _lru_tail(nullptr) {}
+        : _max_size(max_size), _free_size(max_size), _lru_head(nullptr), _lru_tail(nullptr), _version(0) {}
 
     ~SimpleLRU() {
         _lru_index.clear();
@@ -36,33 +38,67 @@ private:
     // LRU cache node
     using lru_node = struct lru_node {
         const std::string key;
-        std::string value;
+        Rope value;
+        uint64_t version;
         lru_node *prev;
         std::unique_ptr<lru_node> next;
 
-        lru_node(const std::string key, const std::string value)
-            : key(key), value(value), next(nullptr), prev(nullptr) {}
+        lru_node(const std::string &key, std::string &&value, uint64_t version)
+            : key(key), value(std::move(value)), version(version), next(nullptr), prev(nullptr) {}
     };
 
 public:
     // Implements Afina::Storage interface
-    bool Put(const std::string &key, const std::string &value) override;
+    bool Put(const std::string &key, std::string value, uint64_t *version = nullptr) override;
 
     // Implements Afina::Storage interface
-    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+    bool PutIfAbsent(const std::string &key, std::string value, uint64_t *version = nullptr) override;
 
     // Implements Afina::Storage interface
-    bool Set(const std::string &key, const std::string &value) override;
+    bool Set(const std::string &key, std::string value, uint64_t *version = nullptr) override;
 
     // Implements Afina::Storage interface
     bool Delete(const std::string &key) override;
 
     // Implements Afina::Storage interface
-    bool Get(const std::string &key, std::string &value) override;
+    bool Get(const std::string &key, std::string &value, uint64_t *version = nullptr) override;
+
+    // Implements Afina::Storage interface
+    bool CompareAndSet(const std::string &key, std::string value, uint64_t &version) override;
+
+    // Implements Afina::Storage interface
+    bool Update(const std::string &key, const std::function<bool(std::string &value)> &fn,
+                uint64_t *version = nullptr) override;
+
+    // Implements Afina::Storage interface
+    bool Append(const std::string &key, std::string data, std::size_t trim, uint64_t *version = nullptr) override;
+
+    // Implements Afina::Storage interface
+    bool Prepend(const std::string &key, std::string data, uint64_t *version = nullptr) override;
+
+    // Implements Afina::Storage interface
+    bool Touch(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    void Clear() override;
 
 private:
-    bool _insert_kv(const std::string &key, const std::string &value);
-    bool _update_kv(const std::string &key, const std::string &value);
+    // Creates node for the key, memory of the value is taken over
+    bool _insert_kv(const std::string &key, std::string &value);
+
+    // Replaces value of the node by the given one, memory of the value is taken over
+    bool _update_value(lru_node &node, std::string &value);
+
+    // Makes node the freshest one and accounts its new size, evicting old nodes to free space. Returns
+    // false if node of that size can't be stored at all
+    bool _resize(lru_node &node, std::size_t size);
+
+    // Reports version to the caller if it asked for one
+    static void _set_version(uint64_t *out, uint64_t version) {
+        if (out != nullptr) {
+            *out = version;
+        }
+    }
 
     bool _move_to_tail(lru_node &node);
     bool _insert(lru_node &node);
@@ -86,6 +122,9 @@ private:
     using node_map =
         std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>, std::less<std::string>>;
     node_map _lru_index;
+
+    // Version of the last created or changed association
+    uint64_t _version;
 };
 
 } // namespace Backend
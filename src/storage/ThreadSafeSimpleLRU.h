@@ -15,48 +15,86 @@ namespace Backend {
  *
  *
  */
-class ThreadSafeSimplLRU : public SimpleLRU {
+class ThreadSafeSimplLRU : public Afina::Storage {
 public:
-    ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
+    ThreadSafeSimplLRU(size_t max_size = 1024) : _lru(max_size) {}
     ~ThreadSafeSimplLRU() {}
 
     // see SimpleLRU.h
-    bool Put(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
+    bool Put(const std::string &key, std::string value, uint64_t *version = nullptr) override {
         std::lock_guard<std::mutex> guard(_m);
-        return SimpleLRU::Put(key, value);
+        return _lru.Put(key, std::move(value), version);
     }
 
     // see SimpleLRU.h
-    bool PutIfAbsent(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
+    bool PutIfAbsent(const std::string &key, std::string value, uint64_t *version = nullptr) override {
         std::lock_guard<std::mutex> guard(_m);
-        return SimpleLRU::PutIfAbsent(key, value);
+        return _lru.PutIfAbsent(key, std::move(value), version);
     }
 
     // see SimpleLRU.h
-    bool Set(const std::string &key, const std::string &value) override {
-        // TODO: sinchronization
+    bool Set(const std::string &key, std::string value, uint64_t *version = nullptr) override {
         std::lock_guard<std::mutex> guard(_m);
-        return SimpleLRU::Set(key, value);
+        return _lru.Set(key, std::move(value), version);
     }
 
     // see SimpleLRU.h
     bool Delete(const std::string &key) override {
-        // TODO: sinchronization
         std::lock_guard<std::mutex> guard(_m);
-        return SimpleLRU::Delete(key);
+        return _lru.Delete(key);
     }
 
     // see SimpleLRU.h
-    bool Get(const std::string &key, std::string &value) override {
-        // TODO: sinchronization
+    bool Get(const std::string &key, std::string &value, uint64_t *version = nullptr) override {
         std::lock_guard<std::mutex> guard(_m);
-        return SimpleLRU::Get(key, value);
+        return _lru.Get(key, value, version);
+    }
+
+    // see SimpleLRU.h
+    bool CompareAndSet(const std::string &key, std::string value, uint64_t &version) override {
+        std::lock_guard<std::mutex> guard(_m);
+        return _lru.CompareAndSet(key, std::move(value), version);
+    }
+
+    // see SimpleLRU.h
+    bool Update(const std::string &key, const std::function<bool(std::string &value)> &fn,
+                uint64_t *version = nullptr) override {
+        std::lock_guard<std::mutex> guard(_m);
+        return _lru.Update(key, fn, version);
+    }
+
+    // see SimpleLRU.h
+    bool Append(const std::string &key, std::string data, std::size_t trim, uint64_t *version = nullptr) override {
+        std::lock_guard<std::mutex> guard(_m);
+        return _lru.Append(key, std::move(data), trim, version);
+    }
+
+    // see SimpleLRU.h
+    bool Prepend(const std::string &key, std::string data, uint64_t *version = nullptr) override {
+        std::lock_guard<std::mutex> guard(_m);
+        return _lru.Prepend(key, std::move(data), version);
+    }
+
+    // see SimpleLRU.h
+    bool Touch(const std::string &key) override {
+        std::lock_guard<std::mutex> guard(_m);
+        return _lru.Touch(key);
+    }
+
+    // see SimpleLRU.h
+    void Clear() override {
+        std::lock_guard<std::mutex> guard(_m);
+        _lru.Clear();
+    }
+
+    // see Storage.h, fn works with the unsynchronized storage while the lock is held
+    void Batch(const std::function<void(Storage &storage)> &fn) override {
+        std::lock_guard<std::mutex> guard(_m);
+        fn(_lru);
     }
 
 private:
-    // TODO: sinchronization primitives
+    SimpleLRU _lru;
     std::mutex _m;
 };
 
@@ -62,3 +62,269 @@ TEST(CoroutineTest, Printer) {
     engine.start(_printer, engine, result);
     ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
 }
+
+TEST(CoroutineTest, SeparateSimpleStart) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate);
+
+    int result;
+    engine.start(_calculator_add, result, 1, 2);
+
+    ASSERT_EQ(3, result);
+}
+
+TEST(CoroutineTest, SeparatePrinter) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate);
+
+    out.str("");
+    std::string result;
+    engine.start(_printer, engine, result);
+    ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
+}
+
+int _deep(Afina::Coroutine::Engine &pe, int depth) {
+    volatile char frame[512];
+    frame[0] = static_cast<char>(depth);
+    if (depth == 0) {
+        pe.yield();
+        return frame[0];
+    }
+    return _deep(pe, depth - 1) + 1 + frame[0] - static_cast<char>(depth);
+}
+
+void _deep_runner(Afina::Coroutine::Engine &pe, int &result) { result = _deep(pe, 200); }
+
+void _deep_main(Afina::Coroutine::Engine &pe, int &left, int &right) {
+    pe.run(_deep_runner, pe, left);
+    pe.run(_deep_runner, pe, right);
+}
+
+TEST(CoroutineTest, SeparateDeepStacks) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate, 256 * 1024);
+
+    int left = 0, right = 0;
+    engine.start(_deep_main, engine, left, right);
+    ASSERT_EQ(200, left);
+    ASSERT_EQ(200, right);
+}
+
+TEST(CoroutineTest, SeparateBlockWake) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+
+    Afina::Coroutine::Engine::context *sleeper = nullptr;
+    int idle_calls = 0;
+    Afina::Coroutine::Engine engine(
+        [&]() {
+            idle_calls++;
+            engine.Wake(sleeper);
+        },
+        Afina::Coroutine::Engine::StackMode::Separate);
+
+    std::string result;
+    engine.start_noargs([&]() {
+        sleeper = engine.get_cur_routine();
+        result += "before ";
+        engine.Block();
+        result += "after";
+    });
+
+    ASSERT_EQ(1, idle_calls);
+    ASSERT_EQ("before after", result);
+}
+
+struct _wake_state {
+    Afina::Coroutine::Engine *pe;
+    void *sleeper;
+    std::string trace;
+};
+
+void _wake_sleeper(_wake_state &st) {
+    st.trace += "s1 ";
+    st.pe->Block();
+    st.trace += "s2 ";
+}
+
+void _wake_waker(_wake_state &st) {
+    st.trace += "w ";
+    st.pe->Wake(static_cast<Afina::Coroutine::Engine::context *>(st.sleeper));
+}
+
+void _wake_main(_wake_state &st) {
+    st.sleeper = st.pe->run(_wake_sleeper, st);
+    st.pe->run(_wake_waker, st);
+    st.pe->sched(st.sleeper);
+    st.pe->yield();
+    st.trace += "main";
+}
+
+TEST(CoroutineTest, SeparateWakeFromCoroutine) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate);
+
+    _wake_state st{&engine, nullptr, ""};
+    engine.start(_wake_main, st);
+    ASSERT_NE(std::string::npos, st.trace.find("s2"));
+    ASSERT_NE(std::string::npos, st.trace.find("main"));
+}
+
+TEST(CoroutineTest, SeparateSleep) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate);
+
+    std::string trace;
+    auto begin = Afina::Coroutine::Engine::Clock::now();
+    engine.start_noargs([&]() {
+        engine.run_noargs([&]() {
+            engine.sleep_for(std::chrono::milliseconds(30));
+            trace += "long ";
+        });
+        engine.run_noargs([&]() {
+            engine.sleep_for(std::chrono::milliseconds(10));
+            trace += "short ";
+        });
+        trace += "main ";
+    });
+
+    ASSERT_EQ("main short long ", trace);
+    ASSERT_GE(Afina::Coroutine::Engine::Clock::now() - begin, std::chrono::milliseconds(30));
+}
+
+TEST(CoroutineTest, SeparateBlockUntil) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate);
+
+    bool woken = false, expired = true;
+    engine.start_noargs([&]() {
+        Afina::Coroutine::Engine::context *sleeper = nullptr;
+        engine.run_noargs([&]() {
+            sleeper = engine.get_cur_routine();
+            woken = engine.BlockUntil(Afina::Coroutine::Engine::Clock::now() + std::chrono::seconds(10));
+        });
+        engine.run_noargs([&]() {
+            expired = engine.BlockUntil(Afina::Coroutine::Engine::Clock::now() + std::chrono::milliseconds(5));
+        });
+
+        // Let both of them block
+        engine.yield();
+        engine.yield();
+        ASSERT_EQ(0, engine.NextTimeout() / 1000);
+        engine.Wake(sleeper);
+    });
+
+    ASSERT_TRUE(woken);
+    ASSERT_FALSE(expired);
+    ASSERT_EQ(-1, engine.NextTimeout());
+}
+
+void _round_robin(Afina::Coroutine::Engine &pe, std::string &trace, char name) {
+    for (int i = 0; i < 3; i++) {
+        trace += name;
+        pe.yield();
+    }
+}
+
+void _round_robin_main(Afina::Coroutine::Engine &pe, std::string &trace) {
+    pe.run(_round_robin, pe, trace, 'a');
+    pe.run(_round_robin, pe, trace, 'b');
+    pe.run(_round_robin, pe, trace, 'c');
+}
+
+TEST(CoroutineTest, RoundRobin) {
+    std::string trace;
+    Afina::Coroutine::Engine copy;
+    copy.start(_round_robin_main, copy, trace);
+    ASSERT_EQ("abcabcabc", trace);
+
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    trace.clear();
+    Afina::Coroutine::Engine separate(Afina::Coroutine::Engine::StackMode::Separate);
+    separate.start(_round_robin_main, separate, trace);
+    ASSERT_EQ("abcabcabc", trace);
+}
+
+TEST(CoroutineTest, SeparateHandoff) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate);
+
+    // Two coroutines keep handing control to each other while a third one waits in the queue: handoff lets
+    // them skip the queue only for a quantum
+    typedef Afina::Coroutine::Engine::context context;
+    const int limit = 4 * Afina::Coroutine::Engine::DefaultQuantum;
+    int ping_pongs = 0, finished = 0, first_queued = -1;
+    context *left = nullptr, *right = nullptr;
+    auto player = [&](context *&self, context *&other) {
+        self = engine.get_cur_routine();
+        if (other == nullptr) {
+            engine.Block();
+        }
+        while (ping_pongs < limit) {
+            ping_pongs++;
+            engine.Handoff(other);
+            engine.Block();
+        }
+        if (finished++ == 0) {
+            engine.Wake(other);
+        }
+    };
+
+    engine.start_noargs([&]() {
+        engine.run_noargs([&]() { player(left, right); });
+        engine.run_noargs([&]() { player(right, left); });
+        engine.run_noargs([&]() { first_queued = ping_pongs; });
+    });
+
+    ASSERT_EQ(limit, ping_pongs);
+    ASSERT_GE(first_queued, int(Afina::Coroutine::Engine::DefaultQuantum));
+    ASSERT_LE(first_queued, int(Afina::Coroutine::Engine::DefaultQuantum) + 2);
+}
+
+TEST(CoroutineTest, SchedulerStats) {
+    if (!Afina::Coroutine::Engine::SeparateStackSupported()) {
+        return;
+    }
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::StackMode::Separate, 16 * 1024);
+
+    const int coroutines = 1000;
+    Afina::Coroutine::Engine::Stats during;
+    engine.start_noargs([&]() {
+        for (int i = 0; i < coroutines; i++) {
+            engine.run_noargs([&]() {
+                engine.yield();
+                engine.sleep_for(std::chrono::milliseconds(1));
+            });
+        }
+        // Let everyone yield once and then fall asleep
+        engine.yield();
+        engine.yield();
+        during = engine.GetStats();
+    });
+
+    ASSERT_EQ(1u, during.runnable);
+    ASSERT_EQ(size_t(coroutines), during.blocked);
+    ASSERT_EQ(size_t(coroutines + 1), during.max_runnable);
+
+    Afina::Coroutine::Engine::Stats after = engine.GetStats();
+    ASSERT_EQ(0u, after.runnable);
+    ASSERT_EQ(0u, after.blocked);
+    ASSERT_GE(after.switches, 3u * coroutines);
+}
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/StackPool.h>
+
+using namespace Afina::Coroutine;
+
+TEST(StackPoolTest, SizeClasses) {
+    StackPool pool;
+
+    std::size_t size = 1;
+    char *small = pool.AcquireBuffer(size);
+    ASSERT_EQ(StackPool::MinBufferSize, size);
+
+    size = 3000;
+    char *buffer = pool.AcquireBuffer(size);
+    ASSERT_EQ(4096, size);
+    pool.ReleaseBuffer(buffer, size);
+
+    // Same class gets the same memory back
+    size = 2500;
+    ASSERT_EQ(buffer, pool.AcquireBuffer(size));
+    ASSERT_EQ(4096, size);
+
+    pool.ReleaseBuffer(buffer, size);
+    pool.ReleaseBuffer(small, StackPool::MinBufferSize);
+    ASSERT_EQ(2, pool.Cached());
+}
+
+TEST(StackPoolTest, BoundedCache) {
+    StackPool pool(2);
+
+    std::size_t size = 100;
+    char *buffers[3];
+    for (auto &buffer : buffers) {
+        buffer = pool.AcquireBuffer(size);
+    }
+    for (auto &buffer : buffers) {
+        pool.ReleaseBuffer(buffer, size);
+    }
+    ASSERT_EQ(2, pool.Cached());
+}
+
+TEST(StackPoolTest, Stacks) {
+    StackPool pool;
+
+    std::size_t size = 10000;
+    char *stack = pool.AcquireStack(size);
+    ASSERT_GT(size, 10000);
+
+    // Usable part is writable
+    stack[size - 1] = 1;
+    pool.ReleaseStack(stack, size);
+
+    std::size_t again = 10000;
+    ASSERT_EQ(stack, pool.AcquireStack(again));
+    ASSERT_EQ(size, again);
+    pool.ReleaseStack(stack, size);
+}
+
+static void _noop(int &counter) { counter++; }
+
+static void _spawner(Engine &engine, int &counter) {
+    for (int i = 0; i < 100; i++) {
+        engine.sched(engine.run(_noop, counter));
+    }
+}
+
+TEST(StackPoolTest, EngineReusesContexts) {
+    for (auto mode : {Engine::StackMode::Copy, Engine::StackMode::Separate}) {
+        if (mode == Engine::StackMode::Separate && !Engine::SeparateStackSupported()) {
+            continue;
+        }
+
+        Engine engine(mode);
+        engine.Prewarm(8);
+
+        int counter = 0;
+        engine.start(_spawner, engine, counter);
+        ASSERT_EQ(100, counter);
+
+        counter = 0;
+        engine.start(_spawner, engine, counter);
+        ASSERT_EQ(100, counter);
+    }
+}
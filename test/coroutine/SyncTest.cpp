@@ -0,0 +1,160 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Sync.h>
+
+using namespace Afina::Coroutine;
+
+// Runs test body in every stack mode supported by the platform
+template <typename F> void _each_mode(F body) {
+    body(Engine::StackMode::Copy);
+    if (Engine::SeparateStackSupported()) {
+        body(Engine::StackMode::Separate);
+    }
+}
+
+// Note that in Copy mode all coroutines share the same stack, so objects they work with together are
+// created outside of the engine
+struct _channel_state {
+    Engine *pe;
+    Channel<int> *ch;
+    WaitGroup *wg;
+    std::vector<int> received;
+    std::string trace;
+};
+
+void _producer(_channel_state &st) {
+    for (int i = 0; i < 5; i++) {
+        st.ch->Send(i);
+        st.trace += "s";
+    }
+    st.ch->Close();
+}
+
+void _consumer(_channel_state &st) {
+    int value;
+    while (st.ch->Receive(value)) {
+        st.received.push_back(value);
+        st.trace += "r";
+    }
+}
+
+void _channel_main(_channel_state &st) {
+    _channel_state *pst = &st;
+    st.wg->Add(2);
+    st.pe->run_noargs([pst]() {
+        _consumer(*pst);
+        pst->wg->Done();
+    });
+    st.pe->run_noargs([pst]() {
+        _producer(*pst);
+        pst->wg->Done();
+    });
+    st.wg->Wait();
+}
+
+TEST(SyncTest, Channel) {
+    _each_mode([](Engine::StackMode mode) {
+        Engine engine(mode);
+        Channel<int> ch(engine, 2);
+        WaitGroup wg(engine);
+        _channel_state st{&engine, &ch, &wg, {}, ""};
+        engine.start(_channel_main, st);
+
+        ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4}), st.received);
+
+        // Producer never gets more than capacity ahead of consumer
+        int ahead = 0;
+        for (char c : st.trace) {
+            ahead += (c == 's') ? 1 : -1;
+            ASSERT_LE(ahead, 2);
+        }
+    });
+}
+
+TEST(SyncTest, ChannelTryOperations) {
+    Engine engine;
+    Channel<std::string> ch(engine, 1);
+    engine.start_noargs([&]() {
+        std::string value;
+        ASSERT_FALSE(ch.TryReceive(value));
+        ASSERT_TRUE(ch.TrySend("a"));
+        ASSERT_FALSE(ch.TrySend("b"));
+
+        ch.Close();
+        ASSERT_FALSE(ch.Send("c"));
+        ASSERT_TRUE(ch.Receive(value));
+        ASSERT_EQ("a", value);
+        ASSERT_FALSE(ch.Receive(value));
+    });
+}
+
+void _locker(Engine &pe, Mutex &m, std::string &trace, char name) {
+    m.Lock();
+    trace += name;
+    pe.yield();
+    trace += name;
+    m.Unlock();
+}
+
+TEST(SyncTest, Mutex) {
+    _each_mode([](Engine::StackMode mode) {
+        Engine engine(mode);
+        Mutex m(engine);
+        WaitGroup wg(engine);
+        std::string trace;
+        engine.start_noargs([&]() {
+            for (char name : std::string("abc")) {
+                wg.Add();
+                Engine *pe = &engine;
+                Mutex *pm = &m;
+                WaitGroup *pwg = &wg;
+                std::string *ptrace = &trace;
+                engine.run_noargs([pe, pm, pwg, ptrace, name]() {
+                    _locker(*pe, *pm, *ptrace, name);
+                    pwg->Done();
+                });
+            }
+            wg.Wait();
+            ASSERT_FALSE(m.Locked());
+        });
+
+        // Critical sections never interleave
+        ASSERT_EQ(6, trace.size());
+        for (std::size_t i = 0; i < trace.size(); i += 2) {
+            ASSERT_EQ(trace[i], trace[i + 1]);
+        }
+    });
+}
+
+TEST(SyncTest, Event) {
+    _each_mode([](Engine::StackMode mode) {
+        Engine engine(mode);
+        Event ev(engine);
+        WaitGroup wg(engine);
+        int passed = 0;
+        engine.start_noargs([&]() {
+            for (int i = 0; i < 3; i++) {
+                wg.Add();
+                Event *pev = &ev;
+                WaitGroup *pwg = &wg;
+                int *ppassed = &passed;
+                engine.run_noargs([pev, pwg, ppassed]() {
+                    pev->Wait();
+                    (*ppassed)++;
+                    pwg->Done();
+                });
+            }
+
+            engine.yield();
+            ASSERT_EQ(0, passed);
+            ev.Set();
+            wg.Wait();
+        });
+        ASSERT_EQ(3, passed);
+    });
+}
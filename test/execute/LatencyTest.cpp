@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <thread>
+
+#include <afina/execute/Latency.h>
+
+using namespace Afina::Execute;
+
+template <typename Layout> void check_buckets() {
+    // Buckets are adjacent: the one after any bucket starts right past its largest value
+    for (std::size_t i = 0; i + 1 < Layout::Buckets; i++) {
+        uint64_t highest = Layout::Highest(i);
+        ASSERT_EQ(i, Layout::Index(highest)) << i;
+        ASSERT_EQ(i + 1, Layout::Index(highest + 1)) << i;
+    }
+    EXPECT_EQ(Layout::Buckets - 1, Layout::Index(Layout::MaxValue));
+    EXPECT_EQ(Layout::Buckets - 1, Layout::Index(~uint64_t(0)));
+}
+
+TEST(LatencyTest, HdrBuckets) {
+    check_buckets<Latency::Histogram::Layout>();
+    check_buckets<HdrBuckets<6>>();
+}
+
+TEST(LatencyTest, SmallValuesAreExact) {
+    Latency::Histogram histogram;
+    EXPECT_EQ(0, histogram.Count());
+    EXPECT_EQ(0, histogram.Percentile(0.5));
+
+    for (uint64_t i = 1; i <= 20; i++) {
+        histogram.Record(i);
+    }
+    EXPECT_EQ(20, histogram.Count());
+    EXPECT_EQ(210, histogram.Sum());
+    EXPECT_EQ(20, histogram.Max());
+    EXPECT_EQ(1, histogram.Percentile(0));
+    EXPECT_EQ(10, histogram.Percentile(0.5));
+    EXPECT_EQ(19, histogram.Percentile(0.95));
+    EXPECT_EQ(20, histogram.Percentile(1));
+}
+
+TEST(LatencyTest, LargeValuesAreClose) {
+    Latency::Histogram histogram;
+    for (uint64_t i = 1; i <= 1000000; i++) {
+        histogram.Record(i * 1000);
+    }
+
+    const double shares[] = {0.5, 0.9, 0.99, 0.999};
+    for (double p : shares) {
+        double expected = p * 1e9;
+        double error = std::abs(double(histogram.Percentile(p)) - expected) / expected;
+        EXPECT_LT(error, 1.0 / Latency::Histogram::SubBuckets) << p;
+    }
+    EXPECT_EQ(1000000000, histogram.Percentile(1));
+
+    // Values past the range are counted as the largest one
+    histogram.Record(uint64_t(1) << 50);
+    EXPECT_EQ(uint64_t(1) << 50, histogram.Max());
+}
+
+TEST(LatencyTest, ThreadsAreCollected) {
+    std::unique_ptr<Latency::Set> before(new Latency::Set);
+    Latency::Collect(*before);
+    uint64_t touches = before->Of(Request::Kind::Touch, Latency::Stage::Storage).Count();
+
+    // Thread finishes before counters are read, they must survive it
+    std::thread([] {
+        for (int i = 0; i < 100; i++) {
+            Latency::Record(Request::Kind::Touch, Latency::Stage::Storage, 500);
+        }
+    }).join();
+    Latency::Record(Request::Kind::Touch, Latency::Stage::Storage, 700);
+
+    std::unique_ptr<Latency::Set> after(new Latency::Set);
+    Latency::Collect(*after);
+    Latency::Histogram &histogram = after->Of(Request::Kind::Touch, Latency::Stage::Storage);
+    EXPECT_EQ(touches + 101, histogram.Count());
+    EXPECT_LE(700, histogram.Max());
+}
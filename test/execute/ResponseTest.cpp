@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include <limits>
+#include <string>
+
+#include <afina/execute/Response.h>
+
+using namespace Afina::Execute;
+
+TEST(ResponseTest, Empty) {
+    Response response;
+    EXPECT_TRUE(response.Empty());
+    EXPECT_EQ(0, response.Size());
+    EXPECT_EQ("", response.Str());
+
+    Response::Segment segments[4];
+    EXPECT_EQ(0, response.Gather(0, segments, 4));
+}
+
+TEST(ResponseTest, Numbers) {
+    Response response;
+    response.Append(uint64_t(0)).Append(" ").Append(uint64_t(42)).Append(" ");
+    response.Append(std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ("0 42 18446744073709551615", response.Str());
+}
+
+TEST(ResponseTest, TextIsMerged) {
+    Response response;
+    response.Append("VALUE ").Append(std::string("key")).Append(" 0 ").Append(uint64_t(5));
+
+    Response::Segment segments[4];
+    ASSERT_EQ(1, response.Gather(0, segments, 4));
+    EXPECT_EQ("VALUE key 0 5", std::string(segments[0].data, segments[0].size));
+}
+
+TEST(ResponseTest, AttachedValues) {
+    Response response;
+    std::string value(64, 'x');
+    const char *data = value.data();
+
+    response.Append("VALUE k 0 64\r\n").Attach(std::move(value)).Append("\r\nEND");
+    EXPECT_EQ(83, response.Size());
+    EXPECT_EQ("VALUE k 0 64\r\n" + std::string(64, 'x') + "\r\nEND", response.Str());
+
+    Response::Segment segments[4];
+    ASSERT_EQ(3, response.Gather(0, segments, 4));
+    EXPECT_EQ(data, segments[1].data) << "Value must not be copied";
+    EXPECT_EQ(64, segments[1].size);
+
+    // Written part of the response is skipped
+    ASSERT_EQ(2, response.Gather(20, segments, 4));
+    EXPECT_EQ(data + 6, segments[0].data);
+    EXPECT_EQ(58, segments[0].size);
+    EXPECT_EQ("\r\nEND", std::string(segments[1].data, segments[1].size));
+    ASSERT_EQ(1, response.Gather(20, segments, 1));
+    EXPECT_EQ(0, response.Gather(83, segments, 4));
+}
+
+TEST(ResponseTest, AppendResponse) {
+    Response batch, response;
+    std::string value(64, 'x');
+    const char *data = value.data();
+
+    batch.Append("STORED\r\n");
+    response.Append("VALUE k 0 64\r\n").Attach(std::move(value)).Append("\r\nEND");
+    batch.Append(std::move(response)).Append("\r\n");
+    EXPECT_TRUE(response.Empty());
+    EXPECT_EQ("STORED\r\nVALUE k 0 64\r\n" + std::string(64, 'x') + "\r\nEND\r\n", batch.Str());
+
+    // Text parts are merged, values are moved over
+    Response::Segment segments[4];
+    ASSERT_EQ(3, batch.Gather(0, segments, 4));
+    EXPECT_EQ(data, segments[1].data) << "Value must not be copied";
+}
+
+TEST(ResponseTest, Outcome) {
+    Response response;
+    EXPECT_EQ(Response::Status::None, response.GetStatus());
+    EXPECT_EQ(nullptr, response.Item());
+
+    std::string first = std::string(64, 'x') + "\r\n", second = "defgh\r\n";
+    const char *data = first.data();
+    response.SetStatus(Response::Status::Found);
+    response.SetVersion(7);
+    response.AttachItem(std::move(first)).AttachItem(std::move(second));
+    ASSERT_NE(nullptr, response.Item());
+    EXPECT_EQ(std::string(64, 'x') + "\r\n", *response.Item());
+    EXPECT_EQ(7, response.Version());
+
+    // Value moves to the other response without its trailing bytes and without copying
+    Response out;
+    out.Attach(std::move(*response.Item()), 64);
+    EXPECT_EQ(std::string(64, 'x'), out.Str());
+    Response::Segment segments[1];
+    ASSERT_EQ(1, out.Gather(0, segments, 1));
+    EXPECT_EQ(data, segments[0].data);
+
+    response.Clear();
+    EXPECT_EQ(Response::Status::None, response.GetStatus());
+    EXPECT_EQ(nullptr, response.Item());
+    EXPECT_EQ(0, response.Version());
+}
+
+TEST(ResponseTest, ClearKeepsNothing) {
+    Response response;
+    response.Append("STORED").Attach(std::string("value"));
+    response.Clear();
+    EXPECT_TRUE(response.Empty());
+
+    std::string out = "prefix ";
+    response.Append("END");
+    response.CopyTo(out);
+    EXPECT_EQ("prefix END", out);
+}
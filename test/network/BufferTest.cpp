@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include <unistd.h>
+
+#include "network/Buffer.h"
+
+using namespace Afina::Network;
+
+std::string drain(Buffer &buffer) {
+    std::string result;
+    while (!buffer.Empty()) {
+        result.append(buffer.Data(), buffer.ContiguousSize());
+        buffer.Consume(buffer.ContiguousSize());
+    }
+    return result;
+}
+
+void append(Buffer &buffer, const std::string &data) {
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        std::size_t size;
+        char *dst = buffer.Prepare(size);
+        size = std::min(size, data.size() - pos);
+        data.copy(dst, size, pos);
+        buffer.Commit(size);
+        pos += size;
+    }
+}
+
+TEST(BufferTest, Empty) {
+    Buffer buffer;
+    EXPECT_TRUE(buffer.Empty());
+    EXPECT_EQ(0, buffer.Size());
+    EXPECT_EQ(nullptr, buffer.Data());
+    EXPECT_EQ(0, buffer.ContiguousSize());
+}
+
+TEST(BufferTest, ConsumeAdvancesInPlace) {
+    Buffer buffer;
+    append(buffer, "get foo\r\nget bar\r\n");
+
+    const char *start = buffer.Data();
+    buffer.Consume(9);
+    EXPECT_EQ(9, buffer.Size());
+    EXPECT_EQ(start + 9, buffer.Data());
+    EXPECT_EQ("get bar\r\n", drain(buffer));
+}
+
+TEST(BufferTest, RewindsWhenDrained) {
+    Buffer buffer;
+    append(buffer, "set");
+    const char *start = buffer.Data();
+    buffer.Consume(3);
+    EXPECT_TRUE(buffer.Empty());
+
+    append(buffer, "get");
+    EXPECT_EQ(start, buffer.Data());
+}
+
+TEST(BufferTest, ChainsBlocks) {
+    std::string data;
+    for (size_t i = 0; data.size() < 3 * Block::Capacity; i++) {
+        data += "VALUE key" + std::to_string(i) + " 0 5\r\nhello\r\n";
+    }
+
+    Buffer buffer;
+    append(buffer, data);
+    EXPECT_EQ(data.size(), buffer.Size());
+    EXPECT_EQ(Block::Capacity, buffer.ContiguousSize());
+
+    // Consume across block boundary
+    buffer.Consume(Block::Capacity + 7);
+    EXPECT_EQ(data.substr(Block::Capacity + 7), drain(buffer));
+}
+
+TEST(BufferTest, ReleasesBlocksToPool) {
+    BlockPool &pool = BlockPool::Local();
+    std::size_t cached;
+    {
+        Buffer buffer;
+        append(buffer, std::string(2 * Block::Capacity + 1, 'x'));
+        cached = pool.Cached();
+
+        buffer.Consume(Block::Capacity);
+        EXPECT_EQ(cached + 1, pool.Cached());
+    }
+    EXPECT_EQ(cached + 3, pool.Cached());
+}
+
+TEST(BufferTest, ReadFrom) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(11, write(fds[1], "stats\r\nget ", 11));
+    close(fds[1]);
+
+    Buffer buffer;
+    EXPECT_EQ(11, buffer.ReadFrom(fds[0]));
+    EXPECT_EQ(0, buffer.ReadFrom(fds[0]));
+    close(fds[0]);
+
+    EXPECT_EQ("stats\r\nget ", drain(buffer));
+}
+
+TEST(BufferTest, AppendWriteTo) {
+    std::string data;
+    for (size_t i = 0; data.size() < 2 * Block::Capacity; i++) {
+        data += "STORED\r\n";
+    }
+
+    Buffer buffer;
+    for (size_t pos = 0; pos < data.size(); pos += 8) {
+        buffer.Append(data.data() + pos, 8);
+    }
+    EXPECT_EQ(data.size(), buffer.Size());
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    EXPECT_EQ(data.size(), buffer.WriteTo(fds[1]));
+    EXPECT_TRUE(buffer.Empty());
+    EXPECT_EQ(0, buffer.WriteTo(fds[1]));
+    close(fds[1]);
+
+    Buffer result;
+    while (result.ReadFrom(fds[0]) > 0) {
+    }
+    close(fds[0]);
+    EXPECT_EQ(data, drain(result));
+}
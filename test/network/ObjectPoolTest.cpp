@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "network/ObjectPool.h"
+
+using namespace Afina::Network;
+
+struct Tracked {
+    Tracked(int &alive, const std::string &name) : alive(alive), name(name) { alive++; }
+    ~Tracked() { alive--; }
+
+    int &alive;
+    std::string name;
+};
+
+struct Throwing {
+    Throwing() { throw std::runtime_error("ctor"); }
+};
+
+TEST(ObjectPoolTest, ReusesMemory) {
+    int alive = 0;
+    ObjectPool<Tracked> pool;
+
+    Tracked *first = pool.Create(alive, "first");
+    EXPECT_EQ(1, alive);
+    EXPECT_EQ("first", first->name);
+
+    pool.Destroy(first);
+    EXPECT_EQ(0, alive);
+    EXPECT_EQ(1, pool.Cached());
+
+    Tracked *second = pool.Create(alive, "second");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ("second", second->name);
+    EXPECT_EQ(0, pool.Cached());
+    pool.Destroy(second);
+}
+
+TEST(ObjectPoolTest, BoundedCache) {
+    int alive = 0;
+    ObjectPool<Tracked> pool(2);
+
+    Tracked *objects[4];
+    for (auto &o : objects) {
+        o = pool.Create(alive, "x");
+    }
+    for (auto &o : objects) {
+        pool.Destroy(o);
+    }
+    EXPECT_EQ(0, alive);
+    EXPECT_EQ(2, pool.Cached());
+}
+
+TEST(ObjectPoolTest, ConstructorThrows) {
+    ObjectPool<Throwing> pool;
+    EXPECT_THROW(pool.Create(), std::runtime_error);
+    EXPECT_EQ(1, pool.Cached());
+}
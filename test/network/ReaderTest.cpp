@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+#include <afina/execute/Response.h>
+
+#include "network/Buffer.h"
+#include "network/Reader.h"
+#include "protocol/Session.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Network;
+
+TEST(ReaderTest, ReadRequests) {
+    auto storage = std::make_shared<Backend::SimpleLRU>();
+    Protocol::Session session(storage);
+    Buffer buffer;
+    Execute::Response out;
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    std::string input = "set a 0 0 1\r\nx\r\nget a\r\n";
+    ASSERT_EQ(ssize_t(input.size()), write(fds[1], input.data(), input.size()));
+    EXPECT_EQ(ssize_t(input.size()), ReadRequests(fds[0], buffer, session, out));
+
+    std::string result;
+    out.CopyTo(result);
+    EXPECT_EQ("STORED\r\nVALUE a 0 1\r\nx\r\nEND\r\n", result);
+    EXPECT_FALSE(session.Closed());
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(ReaderTest, BrokenProtocol) {
+    auto storage = std::make_shared<Backend::SimpleLRU>();
+    Protocol::Session session(storage);
+    Buffer buffer;
+    Execute::Response out;
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    std::string input = "set a 0 0 1\r\nx\r\nget a\r\nbogus_cmd zz\r\nget a\r\n";
+    ASSERT_EQ(ssize_t(input.size()), write(fds[1], input.data(), input.size()));
+    EXPECT_EQ(ssize_t(input.size()), ReadRequests(fds[0], buffer, session, out));
+
+    // Commands before the broken one are executed and answered, session is closed then
+    std::string result;
+    out.CopyTo(result);
+    EXPECT_EQ("STORED\r\nVALUE a 0 1\r\nx\r\nEND\r\n", result);
+    EXPECT_TRUE(session.Closed());
+    EXPECT_FALSE(session.Error().empty());
+
+    session.Reset();
+    EXPECT_FALSE(session.Closed());
+    EXPECT_TRUE(session.Error().empty());
+
+    close(fds[0]);
+    close(fds[1]);
+}
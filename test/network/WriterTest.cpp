@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <afina/execute/Response.h>
+
+#include "network/Buffer.h"
+#include "network/Writer.h"
+
+using namespace Afina;
+using namespace Afina::Network;
+
+namespace {
+
+// Reads whatever the pipe has right now
+std::string read_available(int fd) {
+    std::string result;
+    char chunk[4096];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+        result.append(chunk, n);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(WriterTest, WriteResponses) {
+    Execute::Response responses;
+    responses.Append("VALUE k 0 5\r\n").Attach(std::string("value")).Append("\r\nEND\r\n");
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    EXPECT_EQ(5, WriteResponses(fds[1], responses, 20));
+    EXPECT_EQ(0, WriteResponses(fds[1], responses, responses.Size()));
+    EXPECT_TRUE(WriteAll(fds[1], responses));
+    close(fds[1]);
+
+    EXPECT_EQ("END\r\nVALUE k 0 5\r\nvalue\r\nEND\r\n", read_available(fds[0]));
+    close(fds[0]);
+}
+
+TEST(WriterTest, WriteOrQueue) {
+    // Value doesn't fit into the pipe at once, so the rest of it must wait in the queue
+    std::string value(256 * 1024, 'v');
+    Execute::Response responses;
+    responses.Append("VALUE k 0 262144\r\n").Attach(std::string(value)).Append("\r\nEND\r\n");
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+
+    Buffer queue;
+    ASSERT_TRUE(WriteOrQueue(fds[1], responses, queue));
+    EXPECT_FALSE(queue.Empty());
+    EXPECT_LT(queue.Size(), responses.Size());
+
+    // Once something is queued, next responses go after it
+    Execute::Response next;
+    next.Append("STORED\r\n");
+    ASSERT_TRUE(WriteOrQueue(fds[1], next, queue));
+
+    std::string received = read_available(fds[0]);
+    while (!queue.Empty()) {
+        queue.WriteTo(fds[1]);
+        received += read_available(fds[0]);
+    }
+    close(fds[0]);
+    close(fds[1]);
+    EXPECT_EQ("VALUE k 0 262144\r\n" + value + "\r\nEND\r\nSTORED\r\n", received);
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <protocol/Scanner.h>
+
+using namespace Afina;
+
+// Every implementation must find needle at any offset of any alignment, including vector tails
+TEST(ScannerTest, AllModesAgree) {
+    const Protocol::Scanner::Mode modes[] = {Protocol::Scanner::Mode::Scalar, Protocol::Scanner::Mode::SSE2,
+                                             Protocol::Scanner::Mode::AVX2};
+    std::string buffer(200, 'x');
+    for (auto mode : modes) {
+        if (!Protocol::Scanner::Supported(mode)) {
+            continue;
+        }
+
+        for (size_t begin = 0; begin < 40; begin++) {
+            for (size_t size = 0; begin + size <= 100; size++) {
+                const char *from = buffer.data() + begin, *to = from + size;
+                ASSERT_EQ(to, Protocol::Scanner::Find(mode, from, to, '\n')) << Protocol::Scanner::Name(mode);
+
+                for (size_t at = 0; at < size; at++) {
+                    buffer[begin + at] = '\n';
+                    // Bytes right past the end must be ignored
+                    buffer[begin + size] = ' ';
+                    ASSERT_EQ(from + at, Protocol::Scanner::Find(mode, from, to, '\n')) << Protocol::Scanner::Name(mode);
+                    ASSERT_EQ(to, Protocol::Scanner::Find(mode, from, to, ' ')) << Protocol::Scanner::Name(mode);
+                    buffer[begin + at] = 'x';
+                    buffer[begin + size] = 'x';
+                }
+            }
+        }
+    }
+
+    ASSERT_TRUE(Protocol::Scanner::Supported(Protocol::Scanner::Best()));
+}
+
+TEST(ScannerTest, Terminated) {
+    ASSERT_TRUE(Protocol::Scanner::Terminated("value\r\n", 7));
+    ASSERT_TRUE(Protocol::Scanner::Terminated("\r\n", 2));
+    ASSERT_FALSE(Protocol::Scanner::Terminated("value\n\r", 7));
+    ASSERT_FALSE(Protocol::Scanner::Terminated("\n", 1));
+}
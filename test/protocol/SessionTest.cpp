@@ -0,0 +1,547 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <afina/execute/Latency.h>
+#include <afina/execute/Response.h>
+#include <protocol/BinaryParser.h>
+#include <protocol/Session.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+using Protocol::BinaryParser;
+
+namespace {
+
+void put16(std::string &out, uint16_t v) {
+    out += char(v >> 8);
+    out += char(v);
+}
+
+void put32(std::string &out, uint32_t v) {
+    put16(out, uint16_t(v >> 16));
+    put16(out, uint16_t(v));
+}
+
+// Counts how many batches session runs
+class CountingLRU : public Backend::SimpleLRU {
+public:
+    CountingLRU() : batches(0) {}
+
+    void Batch(const std::function<void(Storage &storage)> &fn) override {
+        batches++;
+        SimpleLRU::Batch(fn);
+    }
+
+    int batches;
+};
+
+uint16_t get16(const std::string &in, size_t pos) { return uint16_t(uint8_t(in[pos])) << 8 | uint8_t(in[pos + 1]); }
+
+uint32_t get32(const std::string &in, size_t pos) { return uint32_t(get16(in, pos)) << 16 | get16(in, pos + 2); }
+
+// Builds binary request
+std::string request(uint8_t opcode, const std::string &key, const std::string &extras = "",
+                    const std::string &value = "", uint32_t opaque = 0, uint64_t cas = 0) {
+    std::string result;
+    result += char(BinaryParser::RequestMagic);
+    result += char(opcode);
+    put16(result, key.size());
+    result += char(extras.size());
+    result += '\0';
+    put16(result, 0);
+    put32(result, extras.size() + key.size() + value.size());
+    put32(result, opaque);
+    put32(result, uint32_t(cas >> 32));
+    put32(result, uint32_t(cas));
+    return result + extras + key + value;
+}
+
+std::string storage_extras(uint32_t flags, uint32_t exptime) {
+    std::string result;
+    put32(result, flags);
+    put32(result, exptime);
+    return result;
+}
+
+// Decoded binary response
+struct Response {
+    uint8_t opcode;
+    uint16_t status;
+    uint32_t opaque;
+    uint64_t cas;
+    std::string extras;
+    std::string key;
+    std::string value;
+};
+
+// Cuts the first response out of the stream
+Response response(std::string &in) {
+    if (in.size() < BinaryParser::HeaderSize || uint8_t(in[0]) != BinaryParser::ResponseMagic) {
+        throw std::runtime_error("No response");
+    }
+
+    Response result;
+    result.opcode = uint8_t(in[1]);
+    size_t key_size = get16(in, 2);
+    size_t extras_size = uint8_t(in[4]);
+    result.status = get16(in, 6);
+    size_t body_size = get32(in, 8);
+    result.opaque = get32(in, 12);
+    result.cas = uint64_t(get32(in, 16)) << 32 | get32(in, 20);
+
+    size_t pos = BinaryParser::HeaderSize;
+    result.extras = in.substr(pos, extras_size);
+    result.key = in.substr(pos + extras_size, key_size);
+    result.value = in.substr(pos + extras_size + key_size, body_size - extras_size - key_size);
+    in.erase(0, pos + body_size);
+    return result;
+}
+
+// Feeds input to the session, responses are appended to out as they would go to the socket
+void process(Protocol::Session &session, const char *input, size_t size, std::string &out) {
+    Execute::Response responses;
+    try {
+        session.Process(input, size, responses);
+    } catch (std::runtime_error &ex) {
+        responses.CopyTo(out);
+        throw;
+    }
+    responses.CopyTo(out);
+}
+
+// Accounts bytes written to the session window, see process
+void commit(Protocol::Session &session, size_t size, std::string &out) {
+    Execute::Response responses;
+    session.Commit(size);
+    session.Flush(responses);
+    responses.CopyTo(out);
+}
+
+} // namespace
+
+TEST(SessionTest, TextCommands) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string out;
+    std::string input = "set foo 0 0 3\r\nbar\r\nset empty 0 0 0\r\n\r\nget foo empty\r\nprepend foo 0 0 2\r\n>>\r\n"
+                        "get foo\r\n";
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ("STORED\r\nSTORED\r\nVALUE foo 0 3\r\nbar\r\nVALUE empty 0 0\r\n\r\nEND\r\nSTORED\r\n"
+              "VALUE foo 0 5\r\n>>bar\r\nEND\r\n",
+              out);
+}
+
+TEST(SessionTest, TextUpdates) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string out;
+    std::string input = "replace foo 0 0 1\r\n1\r\nset foo 0 0 2\r\n10\r\nreplace foo 0 0 2\r\n41\r\n"
+                        "incr foo 1\r\ndecr foo 50\r\nincr foo 18446744073709551615\r\nincr bar 1\r\n"
+                        "touch foo 10\r\ntouch bar 10\r\nappend foo 0 0 1\r\nx\r\nincr foo 1\r\n"
+                        "delete foo\r\ndelete foo\r\nset bar 0 0 1\r\n1\r\nflush_all 10\r\nget bar\r\nflush_all\r\n"
+                        "get bar\r\n";
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ("NOT_STORED\r\nSTORED\r\nSTORED\r\n42\r\n0\r\n18446744073709551615\r\nNOT_FOUND\r\n"
+              "TOUCHED\r\nNOT_FOUND\r\nSTORED\r\n"
+              "CLIENT_ERROR cannot increment or decrement non-numeric value\r\n"
+              "DELETED\r\nNOT_FOUND\r\nSTORED\r\nCLIENT_ERROR delayed flush is not supported\r\n"
+              "VALUE bar 0 1\r\n1\r\nEND\r\nOK\r\nEND\r\n",
+              out);
+}
+
+TEST(SessionTest, TextNoReply) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string out;
+    std::string input = "set foo 0 0 1 noreply\r\n1\r\nincr foo 41 noreply\r\nadd foo 0 0 1 noreply\r\nx\r\n"
+                        "delete bar noreply\r\ntouch foo 1 noreply\r\nget foo\r\n";
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ("VALUE foo 0 2\r\n42\r\nEND\r\n", out);
+
+    // Client must know that the data block is broken
+    out.clear();
+    input = "set foo 0 0 1 noreply\r\nxyz";
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ("CLIENT_ERROR bad data chunk\r\n", out);
+}
+
+TEST(SessionTest, TextCas) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string out;
+    std::string input = "cas foo 0 0 1 1\r\na\r\nset foo 0 0 1\r\nb\r\ngets foo\r\n";
+    process(session, input.data(), input.size(), out);
+
+    std::string prefix = "NOT_FOUND\r\nSTORED\r\nVALUE foo 0 1 ";
+    ASSERT_EQ(prefix, out.substr(0, prefix.size()));
+    std::string version = out.substr(prefix.size(), out.find("\r\n", prefix.size()) - prefix.size());
+
+    out.clear();
+    input = "cas foo 0 0 1 " + version + "\r\nc\r\ncas foo 0 0 1 " + version + "\r\nd\r\nget foo\r\n";
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ("STORED\r\nEXISTS\r\nVALUE foo 0 1\r\nc\r\nEND\r\n", out);
+}
+
+TEST(SessionTest, Pipelining) {
+    auto storage = std::make_shared<CountingLRU>();
+    Protocol::Session session(storage);
+
+    std::string input, expected;
+    for (int i = 0; i < 100; i++) {
+        std::string key = "key" + std::to_string(i % 10);
+        input += "set " + key + " 0 0 1\r\n" + std::to_string(i % 10) + "\r\nget " + key + "\r\n";
+        expected += "STORED\r\nVALUE " + key + " 0 1\r\n" + std::to_string(i % 10) + "\r\nEND\r\n";
+    }
+
+    // All commands of the input are executed in order as a single batch
+    std::string out;
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ(expected, out);
+    ASSERT_EQ(1, storage->batches);
+
+    // Incomplete command doesn't make a batch
+    out.clear();
+    input = "get key1";
+    process(session, input.data(), input.size(), out);
+    ASSERT_TRUE(out.empty());
+    ASSERT_EQ(1, storage->batches);
+
+    input = "\r\n";
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ("VALUE key1 0 1\r\n1\r\nEND\r\n", out);
+    ASSERT_EQ(2, storage->batches);
+
+    // Commands parsed out of several chunks run as a single batch on flush
+    Execute::Response responses;
+    session.Parse("get key1\r\nget ", 14);
+    session.Parse("key2\r\nget key3\r\n", 16);
+    ASSERT_EQ(2, storage->batches);
+    session.Flush(responses);
+    out.clear();
+    responses.CopyTo(out);
+    ASSERT_EQ("VALUE key1 0 1\r\n1\r\nEND\r\nVALUE key2 0 1\r\n2\r\nEND\r\nVALUE key3 0 1\r\n3\r\nEND\r\n", out);
+    ASSERT_EQ(3, storage->batches);
+}
+
+TEST(SessionTest, ByteByByte) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string text = "set foo 0 0 3\r\nbar\r\nget foo\r\n";
+    std::string out;
+    for (char c : text) {
+        process(session, &c, 1, out);
+    }
+    ASSERT_EQ("STORED\r\nVALUE foo 0 3\r\nbar\r\nEND\r\n", out);
+
+    session.Reset();
+    out.clear();
+    std::string binary = request(BinaryParser::Set, "foo", storage_extras(0, 0), "baz") +
+                         request(BinaryParser::GetK, "foo", "", "", 7);
+    for (char c : binary) {
+        process(session, &c, 1, out);
+    }
+
+    Response set = response(out);
+    ASSERT_EQ(BinaryParser::Set, set.opcode);
+    ASSERT_EQ(BinaryParser::Success, set.status);
+
+    Response get = response(out);
+    ASSERT_EQ(BinaryParser::GetK, get.opcode);
+    ASSERT_EQ(BinaryParser::Success, get.status);
+    ASSERT_EQ(7, get.opaque);
+    ASSERT_EQ(std::string(4, '\0'), get.extras);
+    ASSERT_EQ("foo", get.key);
+    ASSERT_EQ("baz", get.value);
+    ASSERT_TRUE(out.empty());
+}
+
+TEST(SessionTest, StreamedValues) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>(1024 * 1024));
+
+    std::size_t size;
+    std::string out;
+    ASSERT_EQ(nullptr, session.Window(size));
+
+    // Data block is written right into the window, the way network reads it
+    std::string value(100000, 'x');
+    std::string line = "set foo 0 0 100000\r\n" + value.substr(0, 10);
+    process(session, line.data(), line.size(), out);
+    char *window = session.Window(size);
+    ASSERT_NE(nullptr, window);
+    ASSERT_EQ(value.size() - 10 + 2, size);
+
+    std::memcpy(window, value.data() + 10, 1000);
+    commit(session, 1000, out);
+    window = session.Window(size);
+    ASSERT_EQ(value.size() - 1010 + 2, size);
+    std::memcpy(window, value.data() + 1010, value.size() - 1010);
+    std::memcpy(window + value.size() - 1010, "\r\n", 2);
+    commit(session, size, out);
+    ASSERT_EQ("STORED\r\n", out);
+    ASSERT_EQ(nullptr, session.Window(size));
+
+    // Window and Process could be mixed, chunk must still be terminated
+    out.clear();
+    line = "set bar 0 0 3\r\n";
+    process(session, line.data(), line.size(), out);
+    window = session.Window(size);
+    ASSERT_EQ(5, size);
+    std::memcpy(window, "baz", 3);
+    commit(session, 3, out);
+    process(session, "xx", 2, out);
+    ASSERT_EQ("CLIENT_ERROR bad data chunk\r\n", out);
+
+    // Large values aren't allocated in advance
+    out.clear();
+    line = "set huge 0 0 " + std::to_string(Protocol::Session::MaxPreallocated + 1) + "\r\n";
+    process(session, line.data(), line.size(), out);
+    ASSERT_EQ(nullptr, session.Window(size));
+    session.Reset();
+
+    line = "get foo bar\r\n";
+    process(session, line.data(), line.size(), out);
+    ASSERT_EQ("VALUE foo 0 100000\r\n" + value + "\r\nEND\r\n", out);
+
+    // Binary window covers value only
+    session.Reset();
+    out.clear();
+    std::string binary = request(BinaryParser::Set, "foo", storage_extras(0, 0), "abc");
+    process(session, binary.data(), binary.size() - 3, out);
+    window = session.Window(size);
+    ASSERT_EQ(3, size);
+    std::memcpy(window, "abc", 3);
+    commit(session, 3, out);
+    ASSERT_EQ(BinaryParser::Success, response(out).status);
+
+    binary = request(BinaryParser::Get, "foo");
+    process(session, binary.data(), binary.size(), out);
+    ASSERT_EQ("abc", response(out).value);
+}
+
+TEST(SessionTest, BinaryCommands) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string input = request(BinaryParser::Get, "foo") +
+                        request(BinaryParser::Add, "foo", storage_extras(0, 0), "a") +
+                        request(BinaryParser::Add, "foo", storage_extras(0, 0), "b") +
+                        request(BinaryParser::Replace, "bar", storage_extras(0, 0), "c") +
+                        request(BinaryParser::Append, "foo", "", "z") + request(BinaryParser::Prepend, "foo", "", "x") +
+                        request(BinaryParser::Get, "foo") + request(BinaryParser::Delete, "foo") +
+                        request(BinaryParser::Delete, "foo") + request(BinaryParser::Version, "");
+
+    std::string out;
+    process(session, input.data(), input.size(), out);
+
+    Response miss = response(out);
+    ASSERT_EQ(BinaryParser::KeyNotFound, miss.status);
+    ASSERT_EQ("Not found", miss.value);
+    ASSERT_EQ(BinaryParser::Success, response(out).status);
+    ASSERT_EQ(BinaryParser::KeyExists, response(out).status);
+    ASSERT_EQ(BinaryParser::KeyNotFound, response(out).status);
+    ASSERT_EQ(BinaryParser::Success, response(out).status);
+    ASSERT_EQ(BinaryParser::Success, response(out).status);
+
+    Response hit = response(out);
+    ASSERT_EQ(BinaryParser::Success, hit.status);
+    ASSERT_EQ("", hit.key);
+    ASSERT_EQ("xaz", hit.value);
+
+    ASSERT_EQ(BinaryParser::Success, response(out).status);
+    ASSERT_EQ(BinaryParser::KeyNotFound, response(out).status);
+    ASSERT_EQ(BinaryParser::UnknownCommand, response(out).status);
+    ASSERT_TRUE(out.empty());
+}
+
+TEST(SessionTest, BinaryCounters) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string counter, seed;
+    put32(counter, 0);
+    put32(counter, 5);
+    put32(counter, 0);
+    put32(counter, 100);
+    seed = counter;
+    put32(counter, 0xffffffff);
+    put32(seed, 0);
+    std::string touch(4, '\0');
+
+    std::string input = request(BinaryParser::Increment, "foo", counter) +
+                        request(BinaryParser::Increment, "foo", seed) +
+                        request(BinaryParser::Decrement, "foo", counter) +
+                        request(BinaryParser::Set, "bar", storage_extras(0, 0), "baz") +
+                        request(BinaryParser::Increment, "bar", counter) + request(BinaryParser::Touch, "bar", touch) +
+                        request(BinaryParser::FlushQ, "") + request(BinaryParser::Touch, "bar", touch);
+
+    std::string out;
+    process(session, input.data(), input.size(), out);
+
+    ASSERT_EQ(BinaryParser::KeyNotFound, response(out).status);
+    ASSERT_EQ(std::string("\0\0\0\0\0\0\0\x64", 8), response(out).value);
+    ASSERT_EQ(std::string("\0\0\0\0\0\0\0\x5f", 8), response(out).value);
+    ASSERT_EQ(BinaryParser::Success, response(out).status);
+    ASSERT_EQ(BinaryParser::NonNumeric, response(out).status);
+    ASSERT_EQ(BinaryParser::Success, response(out).status);
+    ASSERT_EQ(BinaryParser::KeyNotFound, response(out).status);
+    ASSERT_TRUE(out.empty());
+}
+
+TEST(SessionTest, BinaryCas) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string input = request(BinaryParser::Set, "foo", storage_extras(0, 0), "a", 0, 1) +
+                        request(BinaryParser::Set, "foo", storage_extras(0, 0), "b") +
+                        request(BinaryParser::Get, "foo");
+    std::string out;
+    process(session, input.data(), input.size(), out);
+
+    ASSERT_EQ(BinaryParser::KeyNotFound, response(out).status);
+    Response set = response(out);
+    ASSERT_EQ(BinaryParser::Success, set.status);
+    ASSERT_NE(0, set.cas);
+    Response get = response(out);
+    ASSERT_EQ(set.cas, get.cas);
+
+    input = request(BinaryParser::Replace, "foo", storage_extras(0, 0), "c", 0, get.cas) +
+            request(BinaryParser::Set, "foo", storage_extras(0, 0), "d", 0, get.cas) +
+            request(BinaryParser::Add, "bar", storage_extras(0, 0), "e", 0, get.cas) +
+            request(BinaryParser::Get, "foo");
+    process(session, input.data(), input.size(), out);
+
+    // Version store responses carry lets client go on with the next cas
+    Response replaced = response(out);
+    ASSERT_EQ(BinaryParser::Success, replaced.status);
+    ASSERT_NE(get.cas, replaced.cas);
+    ASSERT_EQ(BinaryParser::KeyExists, response(out).status);
+    ASSERT_EQ(BinaryParser::InvalidArguments, response(out).status);
+    Response changed = response(out);
+    ASSERT_EQ("c", changed.value);
+    ASSERT_EQ(replaced.cas, changed.cas);
+
+    input = request(BinaryParser::Increment, "foo", std::string(20, '\0')) +
+            request(BinaryParser::Append, "foo", "", "1", 0, 0) + request(BinaryParser::Get, "foo");
+    process(session, input.data(), input.size(), out);
+    ASSERT_EQ(BinaryParser::NonNumeric, response(out).status);
+    Response appended = response(out);
+    ASSERT_EQ(BinaryParser::Success, appended.status);
+    ASSERT_NE(changed.cas, appended.cas);
+    ASSERT_EQ(appended.cas, response(out).cas);
+    ASSERT_TRUE(out.empty());
+}
+
+TEST(SessionTest, QuietCommands) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    std::string input = request(BinaryParser::SetQ, "foo", storage_extras(0, 0), "bar") +
+                        request(BinaryParser::GetQ, "missing") + request(BinaryParser::GetKQ, "foo") +
+                        request(BinaryParser::AddQ, "foo", storage_extras(0, 0), "baz") +
+                        request(BinaryParser::Noop, "");
+
+    std::string out;
+    process(session, input.data(), input.size(), out);
+
+    // Only hits and errors are answered, noop tells that batch is over
+    Response hit = response(out);
+    ASSERT_EQ(BinaryParser::GetKQ, hit.opcode);
+    ASSERT_EQ("foo", hit.key);
+    ASSERT_EQ("bar", hit.value);
+    ASSERT_EQ(BinaryParser::KeyExists, response(out).status);
+    ASSERT_EQ(BinaryParser::Noop, response(out).opcode);
+    ASSERT_TRUE(out.empty());
+}
+
+TEST(SessionTest, Latency) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    // Every command is measured
+    Execute::Latency::SetSampling(1);
+    std::string out;
+    std::string input = "set foo 0 0 3\r\nbar\r\nget foo\r\n";
+    process(session, input.data(), input.size(), out);
+    EXPECT_EQ("STORED\r\nVALUE foo 0 3\r\nbar\r\nEND\r\n", out);
+
+    // Network layer tells how long responses are written
+    session.BeginWrite();
+    session.EndWrite();
+
+    // Batch is recorded once it is executed, so statistics are asked for by the next one
+    out.clear();
+    input = "stats commands\r\n";
+    process(session, input.data(), input.size(), out);
+    Execute::Latency::SetSampling(0);
+
+    ASSERT_EQ(0, out.find("STAT sampling 1\r\n")) << out;
+    EXPECT_NE(std::string::npos, out.find("STAT set:measured ")) << out;
+    EXPECT_NE(std::string::npos, out.find("STAT get:storage:mean_ns ")) << out;
+
+    out.clear();
+    input = "stats latency\r\nstats\r\nstats nothing\r\n";
+    process(session, input.data(), input.size(), out);
+    EXPECT_NE(std::string::npos, out.find("STAT set:parse:p50_ns ")) << out;
+    EXPECT_NE(std::string::npos, out.find("STAT get:write:max_ns ")) << out;
+    EXPECT_NE(std::string::npos, out.find("END\r\nEND\r\nCLIENT_ERROR unknown stats group\r\n")) << out;
+}
+
+TEST(SessionTest, LatencyNoReply) {
+    typedef Execute::Latency Latency;
+    std::unique_ptr<Latency::Set> before(new Latency::Set);
+    Latency::Collect(*before);
+
+    // Neither text noreply nor binary quiet commands write anything, so they get no write record
+    Latency::SetSampling(1);
+    std::string out;
+    Protocol::Session text(std::make_shared<Backend::SimpleLRU>());
+    std::string input = "set foo 0 0 3 noreply\r\nbar\r\n";
+    process(text, input.data(), input.size(), out);
+    text.BeginWrite();
+    text.EndWrite();
+
+    Protocol::Session binary(std::make_shared<Backend::SimpleLRU>());
+    input = request(BinaryParser::SetQ, "foo", storage_extras(0, 0), "bar");
+    process(binary, input.data(), input.size(), out);
+    binary.BeginWrite();
+    binary.EndWrite();
+    Latency::SetSampling(0);
+    ASSERT_TRUE(out.empty());
+
+    std::unique_ptr<Latency::Set> after(new Latency::Set);
+    Latency::Collect(*after);
+    const Latency::Histogram &parse_before = before->Of(Execute::Request::Kind::Set, Latency::Stage::Parse);
+    const Latency::Histogram &parse_after = after->Of(Execute::Request::Kind::Set, Latency::Stage::Parse);
+    const Latency::Histogram &write_before = before->Of(Execute::Request::Kind::Set, Latency::Stage::Write);
+    const Latency::Histogram &write_after = after->Of(Execute::Request::Kind::Set, Latency::Stage::Write);
+    EXPECT_EQ(parse_before.Count() + 2, parse_after.Count());
+    EXPECT_EQ(write_before.Count(), write_after.Count());
+}
+
+TEST(SessionTest, Errors) {
+    Protocol::Session session(std::make_shared<Backend::SimpleLRU>());
+
+    // Set without extras is answered with error, value is skipped
+    std::string input = request(BinaryParser::Set, "foo", "", "bar") + request(BinaryParser::Get, "foo") +
+                        request(BinaryParser::Quit, "") + request(BinaryParser::Noop, "");
+    std::string out;
+    process(session, input.data(), input.size(), out);
+
+    ASSERT_EQ(BinaryParser::InvalidArguments, response(out).status);
+    ASSERT_EQ(BinaryParser::KeyNotFound, response(out).status);
+    ASSERT_EQ(BinaryParser::Quit, response(out).opcode);
+    ASSERT_TRUE(out.empty());
+    ASSERT_TRUE(session.Closed());
+
+    // Protocol is chosen once per connection
+    // Commands received before the broken one are executed anyway
+    session.Reset();
+    input = "get foo\r\n" + request(BinaryParser::Noop, "");
+    ASSERT_THROW(process(session, input.data(), input.size(), out), std::runtime_error);
+    ASSERT_EQ("END\r\n", out);
+
+    session.Reset();
+    input = request(BinaryParser::Noop, "") + "get foo bar baz quux corge\r\n";
+    ASSERT_THROW(process(session, input.data(), input.size(), out), std::runtime_error);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <afina/execute/Get.h>
+#include <afina/execute/InsertCommand.h>
+#include <afina/execute/Request.h>
+
+#include <protocol/Parser.h>
+#include <protocol/TextParser.h>
+
+using namespace Afina;
+
+TEST(TextParserTest, SpansPointIntoInput) {
+    Protocol::TextParser parser;
+
+    std::string input = "get ke key2 super_long_key\r\nget other\r\n";
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse(input, consumed));
+    ASSERT_EQ(28, consumed);
+    ASSERT_STREQ("get", parser.Name());
+    ASSERT_EQ(3, parser.Keys().size());
+    ASSERT_EQ(input.data() + 4, parser.Keys()[0].data);
+    ASSERT_EQ("key2", parser.Keys()[1].str());
+    ASSERT_EQ("super_long_key", parser.Keys()[2].str());
+
+    // Parser doesn't go further till reset
+    ASSERT_TRUE(parser.Parse(input.data() + consumed, input.size() - consumed, consumed));
+    ASSERT_EQ(0, consumed);
+}
+
+TEST(TextParserTest, SplitLine) {
+    Protocol::TextParser parser;
+
+    size_t consumed = 0;
+    ASSERT_FALSE(parser.Parse("set foo 1", consumed));
+    ASSERT_EQ(9, consumed);
+    ASSERT_FALSE(parser.Parse("0 -12", consumed));
+    ASSERT_FALSE(parser.Parse("0 6\r", consumed));
+    ASSERT_TRUE(parser.Parse("\nfooval\r\n", consumed));
+    ASSERT_EQ(1, consumed);
+
+    size_t value_size = 0;
+    Execute::Request request;
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(6, value_size);
+    ASSERT_EQ(Execute::Request::Kind::Set, request.kind);
+    ASSERT_EQ("foo", request.Key());
+    ASSERT_EQ(10, request.flags);
+    ASSERT_EQ(-120, request.expire);
+
+    // Request keeps memory of the keys, but not the keys
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("get a b\r\n", consumed));
+    ASSERT_TRUE(parser.Build(request, value_size));
+    ASSERT_EQ(Execute::Request::Kind::Get, request.kind);
+    ASSERT_EQ(2, request.KeysCount());
+    ASSERT_EQ("b", request.Keys()[1]);
+    ASSERT_EQ(0, request.flags);
+}
+
+TEST(TextParserTest, NoReply) {
+    const char *silent[] = {"set foo 0 0 1 noreply\r\n", "cas foo 0 0 1 7 noreply\r\n", "delete foo noreply\r\n",
+                            "incr foo 1 noreply\r\n",    "touch foo 0 noreply\r\n",     "flush_all noreply\r\n",
+                            "flush_all 10 noreply\r\n"};
+    for (const char *input : silent) {
+        Protocol::TextParser parser;
+        size_t consumed = 0;
+        ASSERT_TRUE(parser.Parse(input, consumed)) << input;
+        ASSERT_TRUE(parser.NoReply()) << input;
+        parser.Reset();
+        ASSERT_FALSE(parser.NoReply());
+    }
+
+    Protocol::TextParser parser;
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("flush_all 10\r\n", consumed));
+    ASSERT_FALSE(parser.NoReply());
+    ASSERT_EQ(10, parser.ExpireTime());
+}
+
+TEST(TextParserTest, Errors) {
+    const char *bad[] = {"unknown\r\n",       "get\r\n",  "set foo 0 0\r\n", "set foo x 0 1\r\n",
+                         "set foo 0 0 1e9\r\n", "get a\n", "stats\n",        "set foo 0 0 99999999999\r\n",
+                         "set foo 0 0 1 reply\r\n", "delete foo 0\r\n", "stats latency now\r\n"};
+    for (const char *input : bad) {
+        Protocol::TextParser parser;
+        size_t consumed = 0;
+        ASSERT_THROW(parser.Parse(input, consumed), std::runtime_error) << input;
+    }
+
+    Protocol::TextParser parser;
+    size_t consumed = 0;
+    std::string line(Protocol::TextParser::MaxLineSize + 1, 'k');
+    ASSERT_THROW(parser.Parse(line, consumed), std::runtime_error);
+}
+
+namespace {
+
+std::string random_key(std::mt19937 &rnd) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-:.";
+    std::string result(1 + rnd() % 40, ' ');
+    for (char &c : result) {
+        c = alphabet[rnd() % (sizeof(alphabet) - 1)];
+    }
+    return result;
+}
+
+// Random valid command line together with its data block
+std::string random_command(std::mt19937 &rnd) {
+    static const char *storage[] = {"set", "add", "append"};
+    switch (rnd() % 3) {
+    case 0: {
+        std::string result = "get";
+        for (unsigned i = 0, n = 1 + rnd() % 5; i < n; i++) {
+            result += " " + random_key(rnd);
+        }
+        return result + "\r\n";
+    }
+    case 1:
+        return "stats\r\n";
+    default: {
+        uint32_t flags = rnd();
+        int32_t exprtime = static_cast<int32_t>(rnd());
+        std::string data(rnd() % 20, 'v');
+        return std::string(storage[rnd() % 3]) + " " + random_key(rnd) + " " + std::to_string(flags >> (rnd() % 32)) +
+               " " + std::to_string(exprtime >> (rnd() % 32)) + " " + std::to_string(data.size()) + "\r\n" + data +
+               "\r\n";
+    }
+    }
+}
+
+// Feeds input in random chunks until the whole command line is parsed, moves position past it
+template <typename P>
+void feed(P &parser, const std::string &input, size_t &pos, std::mt19937 &rnd, std::vector<size_t> &consumed) {
+    parser.Reset();
+    for (;;) {
+        size_t chunk = std::min<size_t>(1 + rnd() % 16, input.size() - pos);
+        size_t parsed = 0;
+        bool done = parser.Parse(input.data() + pos, chunk, parsed);
+        consumed.push_back(parsed);
+        pos += parsed;
+        if (done) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+// Both parsers must see the same commands in any valid pipelined stream, however it is split into reads
+TEST(TextParserTest, FuzzEquivalence) {
+    std::mt19937 rnd(20181019);
+    for (int round = 0; round < 200; round++) {
+        std::string input;
+        for (int i = 0; i < 50; i++) {
+            input += random_command(rnd);
+        }
+
+        Protocol::Parser reference;
+        Protocol::TextParser parser;
+        std::mt19937 split_reference(round), split_parser(round);
+        size_t reference_pos = 0, parser_pos = 0;
+        while (reference_pos < input.size()) {
+            std::vector<size_t> reference_consumed, parser_consumed;
+            feed(reference, input, reference_pos, split_reference, reference_consumed);
+            feed(parser, input, parser_pos, split_parser, parser_consumed);
+            ASSERT_EQ(reference_pos, parser_pos);
+            ASSERT_EQ(reference_consumed, parser_consumed);
+            ASSERT_EQ(reference.Name(), parser.Name());
+
+            size_t expected_body = 0, actual_body = 0;
+            std::unique_ptr<Execute::Command> expected = reference.Build(expected_body);
+            Execute::Request actual;
+            ASSERT_TRUE(parser.Build(actual, actual_body));
+
+            auto *insert = dynamic_cast<Execute::InsertCommand *>(expected.get());
+            if (insert != nullptr) {
+                ASSERT_TRUE(parser.HasBody());
+                ASSERT_EQ(expected_body, actual_body);
+                ASSERT_EQ(insert->key(), actual.Key());
+                ASSERT_EQ(insert->flags(), actual.flags);
+                ASSERT_EQ(insert->expire(), actual.expire);
+                reference_pos += expected_body + 2;
+                parser_pos += actual_body + 2;
+            }
+            auto *get = dynamic_cast<Execute::Get *>(expected.get());
+            if (get != nullptr) {
+                ASSERT_EQ(get->keys(), std::vector<std::string>(actual.Keys(), actual.Keys() + actual.KeysCount()));
+            }
+        }
+    }
+}
@@ -10,7 +10,9 @@
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
 
+#include "storage/Rope.h"
 #include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina::Backend;
 using namespace Afina::Execute;
@@ -52,6 +54,184 @@ TEST(StorageTest, PutIfAbsent) {
     EXPECT_TRUE(value == "val1");
 }
 
+TEST(StorageTest, Update) {
+    SimpleLRU storage;
+
+    storage.Put("KEY1", "val1");
+    EXPECT_TRUE(storage.Update("KEY1", [](std::string &value) {
+        value += "+";
+        return true;
+    }));
+    EXPECT_TRUE(storage.Update("KEY1", [](std::string &value) { return false; }));
+    EXPECT_FALSE(storage.Update("KEY2", [](std::string &value) { return true; }));
+
+    // Value which doesn't fit leaves the old one in place
+    EXPECT_FALSE(storage.Update("KEY1", [](std::string &value) {
+        value.resize(2048);
+        return true;
+    }));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val1+");
+    EXPECT_FALSE(storage.Get("KEY2", value));
+}
+
+TEST(StorageTest, Touch) {
+    // Room for two items only
+    SimpleLRU storage(16);
+
+    storage.Put("KEY1", "val1");
+    storage.Put("KEY2", "val2");
+    uint64_t version;
+    std::string value;
+    ASSERT_TRUE(storage.Get("KEY1", value, &version));
+
+    // Touched item becomes the freshest one, so the other goes first, version stays
+    EXPECT_TRUE(storage.Touch("KEY1"));
+    EXPECT_FALSE(storage.Touch("KEY3"));
+    storage.Put("KEY3", "val3");
+
+    uint64_t touched;
+    EXPECT_TRUE(storage.Get("KEY1", value, &touched));
+    EXPECT_EQ(version, touched);
+    EXPECT_FALSE(storage.Get("KEY2", value));
+}
+
+TEST(StorageTest, AppendPrepend) {
+    SimpleLRU storage;
+
+    uint64_t version;
+    std::string value;
+    storage.Put("KEY1", "val\r\n");
+    storage.Get("KEY1", value, &version);
+    EXPECT_TRUE(storage.Append("KEY1", "ue\r\n", 2));
+    EXPECT_TRUE(storage.Prepend("KEY1", ">>"));
+    EXPECT_FALSE(storage.Append("KEY2", "ue\r\n", 2));
+    EXPECT_FALSE(storage.Prepend("KEY2", ">>"));
+
+    // Value which doesn't fit stays as is
+    EXPECT_FALSE(storage.Append("KEY1", std::string(2048, 'x'), 0));
+
+    uint64_t changed;
+    EXPECT_TRUE(storage.Get("KEY1", value, &changed));
+    EXPECT_TRUE(value == ">>value\r\n");
+    EXPECT_TRUE(changed > version);
+
+    // Growth of the value evicts other keys
+    SimpleLRU small(16);
+    small.Put("a", "1234");
+    small.Put("b", "1234");
+    EXPECT_TRUE(small.Append("b", "12345678", 0));
+    EXPECT_FALSE(small.Get("a", value));
+    EXPECT_TRUE(small.Get("b", value));
+    EXPECT_TRUE(value == "123412345678");
+}
+
+TEST(StorageTest, Rope) {
+    Rope rope;
+    std::string expected;
+    for (int i = 0; i < 1000; i++) {
+        std::string piece(i % 7 + 1, char('a' + i % 26));
+        if (i % 3 == 0) {
+            rope.Prepend(std::string(piece));
+            expected.insert(0, piece);
+        } else {
+            rope.Append(std::string(piece));
+            expected += piece;
+        }
+        if (i % 10 == 5) {
+            rope.Trim(3);
+            expected.resize(expected.size() - 3);
+        }
+        ASSERT_EQ(expected.size(), rope.Size());
+    }
+    EXPECT_EQ(expected, rope.Flat());
+
+    rope.Trim(rope.Size());
+    EXPECT_EQ("", rope.Flat());
+    rope.Prepend("new");
+    EXPECT_EQ("new", rope.Flat());
+}
+
+TEST(StorageTest, Versions) {
+    SimpleLRU storage;
+
+    std::string value;
+    uint64_t first = 0, second = 0;
+    storage.Put("KEY1", "val1");
+    EXPECT_TRUE(storage.Get("KEY1", value, &first));
+    EXPECT_NE(0, first);
+
+    // Every change gives a new version
+    storage.Update("KEY1", [](std::string &value) { return true; });
+    EXPECT_TRUE(storage.Get("KEY1", value, &second));
+    EXPECT_NE(first, second);
+
+    uint64_t version = first;
+    EXPECT_FALSE(storage.CompareAndSet("KEY1", "val2", version));
+    EXPECT_EQ(second, version);
+    EXPECT_TRUE(storage.CompareAndSet("KEY1", "val2", version));
+    EXPECT_NE(second, version);
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val2");
+
+    version = second;
+    EXPECT_FALSE(storage.CompareAndSet("KEY2", "val2", version));
+    EXPECT_EQ(0, version);
+
+    // Writes report the version they give, failed ones report zero
+    uint64_t written = 0;
+    EXPECT_TRUE(storage.Set("KEY1", "val3", &written));
+    EXPECT_TRUE(storage.Get("KEY1", value, &version));
+    EXPECT_EQ(version, written);
+    EXPECT_TRUE(storage.Append("KEY1", "+", 0, &written));
+    EXPECT_NE(version, written);
+    EXPECT_TRUE(storage.Get("KEY1", value, &version));
+    EXPECT_EQ(version, written);
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val4", &written));
+    EXPECT_EQ(0, written);
+    EXPECT_FALSE(storage.Put("KEY2", std::string(2048, 'x'), &written));
+    EXPECT_EQ(0, written);
+}
+
+TEST(StorageTest, Clear) {
+    SimpleLRU storage(100);
+
+    storage.Put("KEY1", "val1");
+    storage.Put("KEY2", "val2");
+    storage.Clear();
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+
+    // All the space is available again
+    EXPECT_TRUE(storage.Put("KEY3", std::string(96, 'x')));
+    EXPECT_TRUE(storage.Get("KEY3", value));
+}
+
+TEST(StorageTest, Batch) {
+    ThreadSafeSimplLRU storage(100);
+
+    // Value passed by a const reference is copied in
+    const std::string val1 = "val1";
+    EXPECT_TRUE(storage.Put("KEY1", val1));
+    storage.Batch([](Afina::Storage &locked) {
+        // Storage is locked once, operations inside don't lock it again
+        std::string value;
+        EXPECT_TRUE(locked.Get("KEY1", value));
+        EXPECT_TRUE(locked.Put("KEY2", value + "2"));
+        EXPECT_TRUE(locked.Update("KEY2", [](std::string &value) { return true; }));
+        EXPECT_TRUE(locked.Delete("KEY1"));
+    });
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val12", value);
+}
+
 std::string pad_space(const std::string &s, size_t length) {
     std::string result = s;
     result.resize(length, ' ');